@@ -44,7 +44,7 @@ static unsigned int brisk_all_items_backend_get_flags(__brisk_unused__ BriskBack
 
 static const gchar *brisk_all_items_backend_get_id(__brisk_unused__ BriskBackend *backend)
 {
-        return "all-items";
+        return g_intern_static_string("all-items");
 }
 
 static const gchar *brisk_all_items_backend_get_display_name(__brisk_unused__ BriskBackend *backend)
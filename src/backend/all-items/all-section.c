@@ -94,7 +94,7 @@ static void brisk_all_items_section_init(BriskAllItemsSection *self)
 
 static const gchar *brisk_all_items_section_get_id(__brisk_unused__ BriskSection *section)
 {
-        return "all-items:main";
+        return g_intern_static_string("all-items:main");
 }
 
 static const gchar *brisk_all_items_section_get_name(__brisk_unused__ BriskSection *section)
@@ -110,7 +110,7 @@ static const GIcon *brisk_all_items_section_get_icon(BriskSection *section)
 
 static const gchar *brisk_all_items_section_get_backend_id(__brisk_unused__ BriskSection *item)
 {
-        return "all-items";
+        return g_intern_static_string("all-items");
 }
 
 /**
@@ -118,9 +118,10 @@ static const gchar *brisk_all_items_section_get_backend_id(__brisk_unused__ Bris
  * Cuz we can show them all. :3
  */
 static gboolean brisk_all_items_section_can_show_item(__brisk_unused__ BriskSection *section,
-                                                      __brisk_unused__ BriskItem *item)
+                                                      BriskItem *item)
 {
-        return TRUE;
+        /* Actions are only found by searching for them */
+        return brisk_item_get_parent(item) == NULL;
 }
 
 /**
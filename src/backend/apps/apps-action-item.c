@@ -0,0 +1,311 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include "util.h"
+#include <string.h>
+
+BRISK_BEGIN_PEDANTIC
+#include "apps-action-item.h"
+BRISK_END_PEDANTIC
+
+enum { PROP_PARENT = 1, PROP_ACTION, N_PROPS };
+
+DEF_AUTOFREE(gchar, g_free)
+
+static GParamSpec *obj_properties[N_PROPS] = {
+        NULL,
+};
+
+struct _BriskAppsActionItemClass {
+        BriskItemClass parent_class;
+};
+
+/**
+ * BriskAppsActionItem is a desktop action (jump list entry) such as
+ * "New Private Window", indexed alongside its application so that it may
+ * be searched for and launched directly.
+ */
+struct _BriskAppsActionItem {
+        BriskItem parent;
+        BriskAppsItem *app;  /**<The application we belong to */
+        gchar *action;       /**<Action name within the desktop file */
+        gchar *display_name; /**<Localised action name */
+        const gchar *id;     /**<Interned "desktop-id:action" */
+};
+
+G_DEFINE_TYPE(BriskAppsActionItem, brisk_apps_action_item, BRISK_TYPE_ITEM)
+
+/**
+ * Basic subclassing
+ */
+static const gchar *brisk_apps_action_item_get_id(BriskItem *item);
+static const gchar *brisk_apps_action_item_get_name(BriskItem *item);
+static const gchar *brisk_apps_action_item_get_summary(BriskItem *item);
+static const GIcon *brisk_apps_action_item_get_icon(BriskItem *item);
+static const char *brisk_apps_action_item_get_backend_id(BriskItem *item);
+static gboolean brisk_apps_action_item_matches_search(BriskItem *item, gchar *term);
+static gboolean brisk_apps_action_item_launch(BriskItem *item, GAppLaunchContext *context);
+static gchar *brisk_apps_action_item_get_uri(BriskItem *item);
+static gsize brisk_apps_action_item_get_memory_size(BriskItem *item);
+static BriskItem *brisk_apps_action_item_get_parent(BriskItem *item);
+static const gchar *brisk_apps_action_item_get_executable(BriskItem *item);
+
+/**
+ * Once we have both the application and the action name we can work out
+ * our identity. The action name comes from the already parsed desktop
+ * file, so this never touches the disk.
+ */
+static void brisk_apps_action_item_update(BriskAppsActionItem *self)
+{
+        GDesktopAppInfo *info = NULL;
+        autofree(gchar) *id = NULL;
+
+        if (!self->app || !self->action) {
+                return;
+        }
+
+        info = brisk_apps_item_get_info(self->app);
+        g_clear_pointer(&self->display_name, g_free);
+        self->display_name = g_desktop_app_info_get_action_name(info, self->action);
+
+        id = g_strdup_printf("%s:%s", brisk_item_get_id(BRISK_ITEM(self->app)), self->action);
+        self->id = g_intern_string(id);
+}
+
+static void brisk_apps_action_item_set_property(GObject *object, guint id, const GValue *value,
+                                                GParamSpec *spec)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(object);
+
+        switch (id) {
+        case PROP_PARENT:
+                g_clear_object(&self->app);
+                self->app = g_value_dup_object(value);
+                brisk_apps_action_item_update(self);
+                break;
+        case PROP_ACTION:
+                g_clear_pointer(&self->action, g_free);
+                self->action = g_value_dup_string(value);
+                brisk_apps_action_item_update(self);
+                break;
+        default:
+                G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, spec);
+                break;
+        }
+}
+
+static void brisk_apps_action_item_get_property(GObject *object, guint id, GValue *value,
+                                                GParamSpec *spec)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(object);
+
+        switch (id) {
+        case PROP_PARENT:
+                g_value_set_object(value, self->app);
+                break;
+        case PROP_ACTION:
+                g_value_set_string(value, self->action);
+                break;
+        default:
+                G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, spec);
+                break;
+        }
+}
+
+/**
+ * brisk_apps_action_item_dispose:
+ *
+ * Clean up a BriskAppsActionItem instance
+ */
+static void brisk_apps_action_item_dispose(GObject *obj)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(obj);
+
+        g_clear_object(&self->app);
+        g_clear_pointer(&self->action, g_free);
+        g_clear_pointer(&self->display_name, g_free);
+
+        G_OBJECT_CLASS(brisk_apps_action_item_parent_class)->dispose(obj);
+}
+
+/**
+ * brisk_apps_action_item_class_init:
+ *
+ * Handle class initialisation
+ */
+static void brisk_apps_action_item_class_init(BriskAppsActionItemClass *klazz)
+{
+        GObjectClass *obj_class = G_OBJECT_CLASS(klazz);
+        BriskItemClass *i_class = BRISK_ITEM_CLASS(klazz);
+
+        /* item vtable hookup */
+        i_class->get_id = brisk_apps_action_item_get_id;
+        i_class->get_name = brisk_apps_action_item_get_name;
+        i_class->get_display_name = brisk_apps_action_item_get_name;
+        i_class->get_summary = brisk_apps_action_item_get_summary;
+        i_class->get_icon = brisk_apps_action_item_get_icon;
+        i_class->get_backend_id = brisk_apps_action_item_get_backend_id;
+        i_class->matches_search = brisk_apps_action_item_matches_search;
+        i_class->launch = brisk_apps_action_item_launch;
+        i_class->get_uri = brisk_apps_action_item_get_uri;
+        i_class->get_memory_size = brisk_apps_action_item_get_memory_size;
+        i_class->get_parent = brisk_apps_action_item_get_parent;
+        i_class->get_executable = brisk_apps_action_item_get_executable;
+
+        /* gobject vtable hookup */
+        obj_class->dispose = brisk_apps_action_item_dispose;
+        obj_class->set_property = brisk_apps_action_item_set_property;
+        obj_class->get_property = brisk_apps_action_item_get_property;
+
+        obj_properties[PROP_PARENT] = g_param_spec_object("parent",
+                                                          "The parent item",
+                                                          "Application owning this action",
+                                                          BRISK_TYPE_APPS_ITEM,
+                                                          G_PARAM_CONSTRUCT_ONLY |
+                                                              G_PARAM_READWRITE);
+        obj_properties[PROP_ACTION] = g_param_spec_string("action",
+                                                          "The action name",
+                                                          "Desktop action within the file",
+                                                          NULL,
+                                                          G_PARAM_CONSTRUCT_ONLY |
+                                                              G_PARAM_READWRITE);
+        g_object_class_install_properties(obj_class, N_PROPS, obj_properties);
+}
+
+/**
+ * brisk_apps_action_item_init:
+ *
+ * Handle construction of the BriskAppsActionItem
+ */
+static void brisk_apps_action_item_init(__brisk_unused__ BriskAppsActionItem *self)
+{
+}
+
+static const gchar *brisk_apps_action_item_get_id(BriskItem *item)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        return self->id;
+}
+
+static const gchar *brisk_apps_action_item_get_name(BriskItem *item)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        return self->display_name;
+}
+
+/**
+ * The application name tells apart the many "New Window" actions
+ */
+static const gchar *brisk_apps_action_item_get_summary(BriskItem *item)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        return brisk_item_get_display_name(BRISK_ITEM(self->app));
+}
+
+static const GIcon *brisk_apps_action_item_get_icon(BriskItem *item)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        return brisk_item_get_icon(BRISK_ITEM(self->app));
+}
+
+static const char *brisk_apps_action_item_get_backend_id(__brisk_unused__ BriskItem *item)
+{
+        return g_intern_static_string("apps");
+}
+
+/**
+ * Only the action's own name is searched, otherwise typing an application's
+ * name would bring up every one of its actions alongside it.
+ */
+__brisk_pure__ static gboolean brisk_apps_action_item_matches_search(BriskItem *item, gchar *term)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        autofree(gchar) *contents = NULL;
+
+        if (!self->display_name) {
+                return FALSE;
+        }
+
+        contents = g_strstrip(g_ascii_strdown(self->display_name, -1));
+        return g_str_match_string(term, contents, TRUE) || strstr(contents, term) != NULL;
+}
+
+static gboolean brisk_apps_action_item_launch(BriskItem *item, GAppLaunchContext *context)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+
+        g_desktop_app_info_launch_action(brisk_apps_item_get_info(self->app),
+                                         self->action,
+                                         context);
+        return TRUE;
+}
+
+/**
+ * Dragging an action out makes no sense on its own, there's no file for it
+ */
+static gchar *brisk_apps_action_item_get_uri(__brisk_unused__ BriskItem *item)
+{
+        return NULL;
+}
+
+/**
+ * The summary and icon belong to our parent, so they aren't counted here
+ */
+static gsize brisk_apps_action_item_get_memory_size(BriskItem *item)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        GTypeQuery query = { 0 };
+
+        g_type_query(G_OBJECT_TYPE(item), &query);
+
+        return query.instance_size + (self->action ? strlen(self->action) + 1 : 0) +
+               (self->display_name ? strlen(self->display_name) + 1 : 0);
+}
+
+static BriskItem *brisk_apps_action_item_get_parent(BriskItem *item)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        return BRISK_ITEM(self->app);
+}
+
+/**
+ * Actions nearly always run the same program with different arguments
+ */
+static const gchar *brisk_apps_action_item_get_executable(BriskItem *item)
+{
+        BriskAppsActionItem *self = BRISK_APPS_ACTION_ITEM(item);
+        return brisk_item_get_executable(BRISK_ITEM(self->app));
+}
+
+/**
+ * brisk_apps_action_item_new:
+ *
+ * Return a new BriskAppsActionItem for the named action of parent
+ */
+BriskItem *brisk_apps_action_item_new(BriskAppsItem *parent, const gchar *action)
+{
+        return g_object_new(BRISK_TYPE_APPS_ACTION_ITEM, "parent", parent, "action", action, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
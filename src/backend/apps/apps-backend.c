@@ -14,9 +14,12 @@
 #include "util.h"
 
 BRISK_BEGIN_PEDANTIC
+#include "apps-action-item.h"
 #include "apps-backend.h"
+#include "apps-info-cache.h"
 #include "apps-item.h"
 #include "apps-section.h"
+#include "trace.h"
 #include <gio/gio.h>
 #include <glib/gi18n.h>
 #include <matemenu-tree.h>
@@ -50,9 +53,56 @@ struct _BriskAppsBackend {
         GAppInfoMonitor *monitor;
         guint monitor_source_id;
         gboolean loaded;
-        GSList *pending_sections;
+        GSettings *settings;
+        GCancellable *cancellable;      /**<Cancels any tree loads still in flight */
+        GHashTable *items;              /**<Emitted items, keyed by interned desktop ID */
+        BriskAppsInfoCache *info_cache; /**<Parsed desktop files kept across reloads */
+        GHashTable *trees;              /**<MateMenuTree per menu ID, kept across reloads */
+        guint n_pending;                /**<Trees still loading */
+        gint64 load_start;              /**<When the current load started */
+        BriskBackendLoadStats stats;    /**<Accumulated for the current load */
 };
 
+/**
+ * BriskAppsTree is the result of loading a single .menu file on a worker
+ * thread, which is then emitted from the main loop.
+ */
+typedef struct BriskAppsTree {
+        gchar *menu_id;            /**<The menu file we're loading */
+        MateMenuTree *menu_tree;   /**<Handed over by the backend and back again */
+        BriskAppsInfoCache *cache; /**<Owned by the backend */
+        GSList *sections;          /**<Floating BriskSection instances */
+        GSList *items;             /**<Floating BriskItem instances */
+        gint64 tree_time;          /**<Time spent walking the menu tree */
+        gint64 parse_time;         /**<Time spent parsing desktop files */
+} BriskAppsTree;
+
+/**
+ * A desktop file found while walking the tree, parsed outside of the lock
+ */
+typedef struct BriskAppsEntry {
+        gchar *desktop_file;
+        const gchar *section_id; /**<Interned ID of the root level section */
+} BriskAppsEntry;
+
+/**
+ * libmate-menu keeps global caches internally and is not thread safe, so only
+ * one worker at a time may walk a menu tree. Parsing the desktop files happens
+ * outside of this lock.
+ */
+static GMutex brisk_apps_tree_lock;
+
+/**
+ * Dropping the last reference to a tree tears down libmate-menu's caches,
+ * which mustn't race a worker walking another tree
+ */
+static void brisk_apps_backend_tree_unref(MateMenuTree *menu_tree)
+{
+        g_mutex_lock(&brisk_apps_tree_lock);
+        matemenu_tree_unref(menu_tree);
+        g_mutex_unlock(&brisk_apps_tree_lock);
+}
+
 G_DEFINE_TYPE(BriskAppsBackend, brisk_apps_backend, BRISK_TYPE_BACKEND)
 
 typedef gchar *gstrv;
@@ -60,10 +110,10 @@ DEF_AUTOFREE(gstrv, g_strfreev)
 DEF_AUTOFREE(GSimpleAction, g_object_unref)
 
 static gboolean brisk_apps_backend_load(BriskBackend *backend);
-static gboolean brisk_apps_backend_build_from_tree(BriskAppsBackend *self, const gchar *id);
-static void brisk_apps_backend_recurse_root(BriskAppsBackend *self,
-                                            MateMenuTreeDirectory *directory,
-                                            MateMenuTreeDirectory *root);
+static gboolean brisk_apps_backend_build_from_tree(BriskAppsTree *tree, GPtrArray *entries);
+static guint brisk_apps_backend_recurse_root(BriskAppsTree *tree, GPtrArray *entries,
+                                             MateMenuTreeDirectory *directory,
+                                             const gchar *section_id);
 static void brisk_apps_backend_changed(BriskAppsBackend *backend, gpointer v);
 static gboolean brisk_apps_backend_reload(BriskAppsBackend *backend);
 static void brisk_apps_backend_launch_action(GSimpleAction *action, GVariant *parameter,
@@ -73,8 +123,9 @@ DEF_AUTOFREE(gchar, g_free)
 DEF_AUTOFREE(GSList, g_slist_free)
 DEF_AUTOFREE(MateMenuTreeDirectory, matemenu_tree_item_unref)
 DEF_AUTOFREE(MateMenuTreeItem, matemenu_tree_item_unref)
-DEF_AUTOFREE(MateMenuTree, matemenu_tree_unref)
 DEF_AUTOFREE(GDesktopAppInfo, g_object_unref)
+DEF_AUTOFREE(GPtrArray, g_ptr_array_unref)
+DEF_AUTOFREE(GHashTable, g_hash_table_unref)
 
 /**
  * Due to a glib weirdness we must fully invalidate the monitor's cache
@@ -86,16 +137,41 @@ static inline void brisk_apps_backend_reset_monitor(void)
 }
 
 /**
- * Reset the pending sections
+ * Drop a floating reference that was never handed out
+ */
+static void brisk_apps_backend_sink_unref(gpointer v)
+{
+        g_object_unref(g_object_ref_sink(v));
+}
+
+static void brisk_apps_entry_free(BriskAppsEntry *entry)
+{
+        g_free(entry->desktop_file);
+        g_free(entry);
+}
+
+/**
+ * Free a tree, along with anything that wasn't emitted
+ */
+static void brisk_apps_tree_free(BriskAppsTree *tree)
+{
+        g_slist_free_full(tree->sections, brisk_apps_backend_sink_unref);
+        g_slist_free_full(tree->items, brisk_apps_backend_sink_unref);
+        g_clear_pointer(&tree->menu_tree, brisk_apps_backend_tree_unref);
+        g_free(tree->menu_id);
+        g_free(tree);
+}
+
+/**
+ * Abandon any tree loads that are still in flight
  */
-static inline void brisk_apps_backend_reset_pending(BriskAppsBackend *self)
+static void brisk_apps_backend_cancel(BriskAppsBackend *self)
 {
-        if (!self->pending_sections) {
+        if (!self->cancellable) {
                 return;
         }
-        /* We use floating references, don't unref them */
-        g_slist_free(self->pending_sections);
-        self->pending_sections = NULL;
+        g_cancellable_cancel(self->cancellable);
+        g_clear_object(&self->cancellable);
 }
 
 /**
@@ -108,7 +184,7 @@ static unsigned int brisk_apps_backend_get_flags(__brisk_unused__ BriskBackend *
 
 static const gchar *brisk_apps_backend_get_id(__brisk_unused__ BriskBackend *backend)
 {
-        return "apps";
+        return g_intern_static_string("apps");
 }
 
 static const gchar *brisk_apps_backend_get_display_name(__brisk_unused__ BriskBackend *backend)
@@ -116,18 +192,34 @@ static const gchar *brisk_apps_backend_get_display_name(__brisk_unused__ BriskBa
         return _("Applications");
 }
 
+/**
+ * Desktop actions for the item. Frontends cache what we return, so this
+ * is only called again once the item has been reloaded.
+ */
 static GMenu *brisk_apps_backend_get_item_actions(BriskBackend *backend, BriskItem *item,
                                                   GActionGroup *group)
 {
         GMenu *ret = NULL;
         GDesktopAppInfo *info = NULL;
+        const gchar *const *actions = NULL;
 
-        ret = g_menu_new();
+        if (!BRISK_IS_APPS_ITEM(item)) {
+                return NULL;
+        }
 
-        info = g_desktop_app_info_new(brisk_item_get_id(item));
-        const gchar *const *actions = g_desktop_app_info_list_actions(info);
+        info = brisk_apps_item_get_info(BRISK_APPS_ITEM(item));
+        if (!info) {
+                return NULL;
+        }
+
+        actions = g_desktop_app_info_list_actions(info);
+        if (!actions || !actions[0]) {
+                return NULL;
+        }
 
-        for (guint i = 0; i < g_strv_length((gstrv *)actions); i++) {
+        ret = g_menu_new();
+
+        for (guint i = 0; actions[i]; i++) {
                 autofree(gchar) *action_id = NULL;
                 autofree(gchar) *menu_id = NULL;
                 const gchar *action_name = NULL;
@@ -147,7 +239,7 @@ static GMenu *brisk_apps_backend_get_item_actions(BriskBackend *backend, BriskIt
                                        g_free);
                 g_object_set_data_full(G_OBJECT(action),
                                        "__appinfo",
-                                       (gpointer)info,
+                                       g_object_ref(info),
                                        g_object_unref);
                 g_signal_connect(action,
                                  "activate",
@@ -171,7 +263,11 @@ static void brisk_apps_backend_dispose(GObject *obj)
         BriskAppsBackend *self = BRISK_APPS_BACKEND(obj);
 
         g_clear_object(&self->monitor);
-        brisk_apps_backend_reset_pending(self);
+        g_clear_object(&self->settings);
+        g_clear_pointer(&self->items, g_hash_table_unref);
+        g_clear_pointer(&self->info_cache, brisk_apps_info_cache_free);
+        g_clear_pointer(&self->trees, g_hash_table_unref);
+        brisk_apps_backend_cancel(self);
 
         G_OBJECT_CLASS(brisk_apps_backend_parent_class)->dispose(obj);
 }
@@ -204,11 +300,25 @@ static void brisk_apps_backend_class_init(BriskAppsBackendClass *klazz)
  */
 static void brisk_apps_backend_init(BriskAppsBackend *self)
 {
+        self->items = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_object_unref);
+        self->info_cache = brisk_apps_info_cache_new();
+        self->trees = g_hash_table_new_full(g_str_hash,
+                                            g_str_equal,
+                                            g_free,
+                                            (GDestroyNotify)brisk_apps_backend_tree_unref);
+
         self->monitor = g_app_info_monitor_get();
         g_signal_connect_swapped(self->monitor,
                                  "changed",
                                  G_CALLBACK(brisk_apps_backend_changed),
                                  self);
+
+        /* Additional menus require a reload, just like any other change */
+        self->settings = g_settings_new("com.solus-project.brisk-menu");
+        g_signal_connect_swapped(self->settings,
+                                 "changed::additional-menus",
+                                 G_CALLBACK(brisk_apps_backend_changed),
+                                 self);
 }
 
 /**
@@ -246,35 +356,289 @@ static gint brisk_apps_backend_sort_section(gconstpointer a, gconstpointer b)
                                   brisk_section_get_name((BriskSection *)b));
 }
 
+/**
+ * A tree is no longer pending, so if it was the last one we're now done
+ */
+static void brisk_apps_backend_tree_done(BriskAppsBackend *self)
+{
+        if (--self->n_pending > 0) {
+                return;
+        }
+
+        self->stats.total_time = g_get_monotonic_time() - self->load_start;
+        brisk_backend_load_finished(BRISK_BACKEND(self), &self->stats);
+}
+
+/**
+ * brisk_apps_backend_tree_loaded:
+ *
+ * A worker finished loading a tree, so emit everything it found right away
+ * rather than waiting on the other trees. Each desktop ID is only ever
+ * emitted once, with any later appearances merged into its sections.
+ *
+ * Sections are sorted per tree, and the frontends keep the section list
+ * itself in order, so the end result doesn't depend on which tree finished
+ * first.
+ */
+static void brisk_apps_backend_tree_loaded(BriskAppsBackend *self, GAsyncResult *result,
+                                           __brisk_unused__ gpointer v)
+{
+        BriskAppsTree *tree = g_task_get_task_data(G_TASK(result));
+        GError *error = NULL;
+        gboolean merged = FALSE;
+        gint64 emit_start = 0;
+
+        brisk_trace_span("apps.emit-tree");
+
+        /* Cancelled loads never emit, they've already been reset and belong
+         * to an earlier load */
+        if (!g_task_propagate_boolean(G_TASK(result), &error)) {
+                if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+                        g_error_free(error);
+                        return;
+                }
+                g_warning("%s", error->message);
+                g_error_free(error);
+                brisk_apps_backend_tree_done(self);
+                return;
+        }
+
+        /* Keep the tree so the next load can reuse what libmate-menu parsed */
+        if (tree->menu_tree) {
+                g_hash_table_replace(self->trees, g_strdup(tree->menu_id), tree->menu_tree);
+                tree->menu_tree = NULL;
+        }
+
+        emit_start = g_get_monotonic_time();
+
+        for (GSList *elem = tree->items; elem; elem = elem->next) {
+                BriskItem *item = elem->data;
+                const gchar *item_id = brisk_item_get_id(elem->data);
+                gpointer existing = NULL;
+
+                /* Already emitted from another tree, just extend its sections.
+                 * Actions have no sections of their own, so there's nothing to
+                 * merge for those. */
+                existing = g_hash_table_lookup(self->items, item_id);
+                if (existing) {
+                        if (BRISK_IS_APPS_ITEM(item)) {
+                                brisk_apps_item_merge_sections(existing, BRISK_APPS_ITEM(item));
+                                merged = TRUE;
+                        }
+                        brisk_apps_backend_sink_unref(item);
+                        continue;
+                }
+
+                g_hash_table_insert(self->items, (gpointer)item_id, g_object_ref(item));
+                brisk_backend_item_added(BRISK_BACKEND(self), elem->data);
+                ++self->stats.n_items;
+        }
+
+        for (GSList *elem = tree->sections; elem; elem = elem->next) {
+                brisk_backend_section_added(BRISK_BACKEND(self), elem->data);
+                ++self->stats.n_sections;
+        }
+
+        /* We use floating references, don't unref them */
+        g_slist_free(tree->items);
+        tree->items = NULL;
+        g_slist_free(tree->sections);
+        tree->sections = NULL;
+
+        /* Existing rows may now belong to more sections */
+        if (merged) {
+                brisk_backend_invalidate_filter(BRISK_BACKEND(self));
+        }
+
+        self->stats.emit_time += g_get_monotonic_time() - emit_start;
+        self->stats.tree_time += tree->tree_time;
+        self->stats.parse_time += tree->parse_time;
+
+        brisk_apps_backend_tree_done(self);
+}
+
+/**
+ * Desktop actions come from the same parsed GDesktopAppInfo, so indexing
+ * them costs no further I/O
+ */
+static void brisk_apps_backend_load_actions(BriskAppsTree *tree, BriskAppsItem *item,
+                                            GDesktopAppInfo *info)
+{
+        const gchar *const *actions = g_desktop_app_info_list_actions(info);
+
+        for (guint i = 0; actions && actions[i]; i++) {
+                tree->items = g_slist_prepend(tree->items,
+                                              brisk_apps_action_item_new(item, actions[i]));
+        }
+}
+
+/**
+ * brisk_apps_backend_load_tree:
+ *
+ * Worker thread function to walk a single menu tree and construct all of the
+ * items and sections within it.
+ */
+static void brisk_apps_backend_load_tree(GTask *task, __brisk_unused__ gpointer source,
+                                         gpointer task_data,
+                                         __brisk_unused__ GCancellable *cancellable)
+{
+        BriskAppsTree *tree = task_data;
+        autofree(GPtrArray) *entries = NULL;
+        autofree(GHashTable) *used_sections = NULL;
+        autofree(GHashTable) *seen_items = NULL;
+        gboolean built = FALSE;
+        GSList *elem = NULL;
+        gint64 start = 0;
+
+        entries = g_ptr_array_new_with_free_func((GDestroyNotify)brisk_apps_entry_free);
+
+        g_mutex_lock(&brisk_apps_tree_lock);
+        start = g_get_monotonic_time();
+        built = brisk_apps_backend_build_from_tree(tree, entries);
+        tree->tree_time = g_get_monotonic_time() - start;
+        g_mutex_unlock(&brisk_apps_tree_lock);
+
+        if (!built) {
+                g_task_return_new_error(task,
+                                        G_IO_ERROR,
+                                        G_IO_ERROR_NOT_FOUND,
+                                        "Failed to load menu id: %s",
+                                        tree->menu_id);
+                return;
+        }
+
+        start = g_get_monotonic_time();
+
+        /* Track which sections actually end up with items */
+        used_sections = g_hash_table_new(g_direct_hash, g_direct_equal);
+        seen_items = g_hash_table_new(g_str_hash, g_str_equal);
+
+        for (guint i = 0; i < entries->len; i++) {
+                BriskAppsEntry *entry = g_ptr_array_index(entries, i);
+                autofree(GDesktopAppInfo) *info = NULL;
+                BriskItem *item = NULL;
+                BriskAppsItem *existing = NULL;
+
+                if (g_task_return_error_if_cancelled(task)) {
+                        return;
+                }
+
+                /* Same desktop file under another category */
+                existing = g_hash_table_lookup(seen_items, entry->desktop_file);
+                if (existing) {
+                        brisk_apps_item_add_section(existing, entry->section_id);
+                } else {
+                        /* Must have a desktop file, unchanged ones come from the cache */
+                        info = brisk_apps_info_cache_lookup(tree->cache, entry->desktop_file);
+                        if (!info) {
+                                continue;
+                        }
+
+                        item = brisk_apps_item_new(info, entry->section_id);
+                        g_hash_table_insert(seen_items, entry->desktop_file, item);
+                        tree->items = g_slist_prepend(tree->items, item);
+                        brisk_apps_backend_load_actions(tree, BRISK_APPS_ITEM(item), info);
+                }
+
+                if (entry->section_id) {
+                        g_hash_table_add(used_sections, (gpointer)entry->section_id);
+                }
+        }
+        tree->items = g_slist_reverse(tree->items);
+        tree->parse_time = g_get_monotonic_time() - start;
+
+        /* Skip sections where no entry could be loaded */
+        elem = tree->sections;
+        while (elem) {
+                GSList *next = elem->next;
+                const gchar *section_id = brisk_section_get_id(elem->data);
+
+                if (!g_hash_table_contains(used_sections, section_id)) {
+                        brisk_apps_backend_sink_unref(elem->data);
+                        tree->sections = g_slist_delete_link(tree->sections, elem);
+                }
+                elem = next;
+        }
+
+        /* Sort before display */
+        tree->sections = g_slist_sort(tree->sections, brisk_apps_backend_sort_section);
+
+        g_task_return_boolean(task, TRUE);
+}
+
+/**
+ * Schedule loading of the given menu id on a worker thread
+ */
+static void brisk_apps_backend_queue_tree(BriskAppsBackend *self, const gchar *menu_id)
+{
+        GTask *task = NULL;
+        BriskAppsTree *tree = NULL;
+        gpointer key = NULL;
+
+        tree = g_new0(BriskAppsTree, 1);
+        tree->menu_id = g_strdup(menu_id);
+        tree->cache = self->info_cache;
+
+        /* Hand over the tree from last time, if we still have it */
+        if (g_hash_table_lookup_extended(self->trees,
+                                         menu_id,
+                                         &key,
+                                         (gpointer *)&tree->menu_tree)) {
+                g_hash_table_steal(self->trees, menu_id);
+                g_free(key);
+        }
+
+        ++self->n_pending;
+
+        task = g_task_new(self,
+                          self->cancellable,
+                          (GAsyncReadyCallback)brisk_apps_backend_tree_loaded,
+                          NULL);
+        g_task_set_task_data(task, tree, (GDestroyNotify)brisk_apps_tree_free);
+        g_task_run_in_thread(task, brisk_apps_backend_load_tree);
+        g_object_unref(task);
+}
+
 /**
  *
  * brisk_apps_backend_init_menus:
  *
  * Handle menu loading, also a handy idle callback function.
+ *
+ * Each menu tree is loaded concurrently on its own worker thread.
  */
 static gboolean brisk_apps_backend_init_menus(BriskAppsBackend *self)
 {
-        brisk_apps_backend_reset_pending(self);
+        autofree(gstrv) *additional = NULL;
 
-        /* Now load them again */
-        if (!brisk_apps_backend_build_from_tree(self, APPS_MENU_ID)) {
-                g_warning("Failed to load required apps menu id: %s", APPS_MENU_ID);
-        }
+        brisk_trace_span("apps.reload");
+
+        /* Any results from a previous load are now stale */
+        brisk_apps_backend_cancel(self);
+        self->cancellable = g_cancellable_new();
+        g_hash_table_remove_all(self->items);
 
-        if (!brisk_apps_backend_build_from_tree(self, SETTINGS_MENU_ID)) {
-                g_warning("Failed to load settings menu id: %s", SETTINGS_MENU_ID);
+        /* $PATH or the desktop changed, so libmate-menu's TryExec and
+         * OnlyShowIn decisions are as stale as ours */
+        if (brisk_apps_info_cache_begin(self->info_cache)) {
+                g_hash_table_remove_all(self->trees);
         }
 
-        /* Sort before display */
-        self->pending_sections =
-            g_slist_sort(self->pending_sections, brisk_apps_backend_sort_section);
+        self->stats = (BriskBackendLoadStats){ 0 };
+        self->load_start = g_get_monotonic_time();
+        self->n_pending = 0;
+        brisk_backend_load_started(BRISK_BACKEND(self));
+
+        brisk_apps_backend_queue_tree(self, APPS_MENU_ID);
+        brisk_apps_backend_queue_tree(self, SETTINGS_MENU_ID);
 
-        for (GSList *elem = self->pending_sections; elem; elem = elem->next) {
-                BriskSection *section = elem->data;
-                brisk_backend_section_added(BRISK_BACKEND(self), section);
+        additional = g_settings_get_strv(self->settings, "additional-menus");
+        for (guint i = 0; additional[i]; i++) {
+                brisk_apps_backend_queue_tree(self, additional[i]);
         }
 
-        brisk_apps_backend_reset_pending(self);
+        /* Whatever wasn't handed over belongs to a menu we no longer load */
+        g_hash_table_remove_all(self->trees);
 
         /* Prevent further runs */
         return G_SOURCE_REMOVE;
@@ -312,7 +676,7 @@ static void brisk_apps_backend_launch_action(GSimpleAction *action,
                                              __brisk_unused__ GVariant *parameter,
                                              BriskBackend *backend)
 {
-        autofree(GDesktopAppInfo) *app_info = g_object_get_data(G_OBJECT(action), "__appinfo");
+        GDesktopAppInfo *app_info = g_object_get_data(G_OBJECT(action), "__appinfo");
         const gchar *action_name = g_object_get_data(G_OBJECT(action), "__aname");
         g_assert(app_info != NULL);
         brisk_backend_hide_menu(backend);
@@ -347,53 +711,69 @@ static gboolean brisk_apps_backend_load(BriskBackend *backend)
  * brisk_apps_backend_build_from_tree:
  *
  * Begin building content using the given tree ID, cleaning up once it's done.
+ * The caller must hold the tree lock.
+ *
+ * A tree kept from the last load still holds libmate-menu's parsed entries,
+ * and its file monitors rebuild only what changed on disk. An unchanged
+ * reload then neither parses nor re-evaluates TryExec, OnlyShowIn and the
+ * like for any desktop file.
  */
-static gboolean brisk_apps_backend_build_from_tree(BriskAppsBackend *self, const gchar *menu_id)
+static gboolean brisk_apps_backend_build_from_tree(BriskAppsTree *tree, GPtrArray *entries)
 {
-        autofree(MateMenuTree) *tree = NULL;
         autofree(MateMenuTreeDirectory) *dir = NULL;
 
-        tree = matemenu_tree_lookup(menu_id, MATEMENU_TREE_FLAGS_NONE);
-        if (!tree) {
+        if (!tree->menu_tree) {
+                tree->menu_tree = matemenu_tree_lookup(tree->menu_id, MATEMENU_TREE_FLAGS_NONE);
+        }
+        if (!tree->menu_tree) {
                 return FALSE;
         }
 
-        dir = matemenu_tree_get_root_directory(tree);
+        dir = matemenu_tree_get_root_directory(tree->menu_tree);
         if (!dir) {
                 return FALSE;
         }
-        brisk_apps_backend_recurse_root(self, dir, dir);
+
+        /* Timed here rather than inside the walk, which recurses and would
+         * count each nested directory again in all of its ancestors */
+        brisk_trace_span("apps.recurse-root");
+        brisk_apps_backend_recurse_root(tree, entries, dir, NULL);
         return TRUE;
 }
 
 /**
- * Return a section ID to help with matching.
+ * Return the interned section ID for a root level directory.
  *
- * In all cases we only use the root level section name, as we forbid
- * nested sections
+ * This matches the ID used by BriskAppsSection, and is only computed once
+ * per directory rather than per entry.
  */
-static gchar *brisk_apps_backend_get_entry_section(MateMenuTreeDirectory *parent,
-                                                   MateMenuTreeEntry *entry)
+static const gchar *brisk_apps_backend_get_section_id(MateMenuTreeDirectory *directory)
 {
-        autofree(gchar) *root_id = matemenu_tree_directory_make_path(parent, entry);
-        gchar **split = g_strsplit(root_id, "/", 5);
-        gchar *ret = g_strdup_printf("%s.mate-directory", split[1]);
-        g_strfreev(split);
-        return ret;
+        autofree(gchar) *id = NULL;
+
+        id = g_strdup_printf("%s.mate-directory", matemenu_tree_directory_get_menu_id(directory));
+        return g_intern_string(id);
 }
 
 /**
  * brisk_apps_backend_recurse_root:
  *
- * Walk the directory and construct sections/items for every directory/entry
- * that we encounter.
+ * Walk the directory and construct sections for every directory we encounter,
+ * queuing every entry to be parsed once we've dropped the tree lock.
+ *
+ * A NULL section_id means we're walking the root of the tree, so any directory
+ * found here becomes a section. Below the root we forbid nested sections, so
+ * the root level section_id is simply passed down to every descendant.
+ *
+ * Returns: The number of entries found in this directory and its children
  */
-static void brisk_apps_backend_recurse_root(BriskAppsBackend *self,
-                                            MateMenuTreeDirectory *directory,
-                                            MateMenuTreeDirectory *root)
+static guint brisk_apps_backend_recurse_root(BriskAppsTree *tree, GPtrArray *entries,
+                                             MateMenuTreeDirectory *directory,
+                                             const gchar *section_id)
 {
         autofree(GSList) *kids = NULL;
         GSList *elem = NULL;
+        guint n_items = 0;
 
         kids = matemenu_tree_directory_get_contents(directory);
 
@@ -404,44 +784,39 @@ static void brisk_apps_backend_recurse_root(BriskAppsBackend *self,
                 switch (matemenu_tree_item_get_type(item)) {
                 case MATEMENU_TREE_ITEM_DIRECTORY: {
                         MateMenuTreeDirectory *dir = MATEMENU_TREE_DIRECTORY(item);
-                        autofree(MateMenuTreeDirectory) *parent = NULL;
                         BriskSection *section = NULL;
-                        GSList *children = NULL;
+                        const gchar *dir_id = NULL;
                         guint n_children = 0;
 
-                        parent = matemenu_tree_item_get_parent(item);
                         /* Nested menus basically only happen in mate-settings.menu */
-                        if (parent != root) {
-                                goto recurse_root;
+                        if (section_id) {
+                                n_items += brisk_apps_backend_recurse_root(tree,
+                                                                           entries,
+                                                                           dir,
+                                                                           section_id);
+                                break;
                         }
 
-                        children = matemenu_tree_directory_get_contents(dir);
-                        if (children) {
-                                n_children = g_slist_length(children);
-                                g_slist_free_full(children, matemenu_tree_item_unref);
-                        }
+                        /* Descend into the section */
+                        dir_id = brisk_apps_backend_get_section_id(dir);
+                        n_children = brisk_apps_backend_recurse_root(tree, entries, dir, dir_id);
 
                         /* Skip empty sections entirely */
                         if (n_children < 1) {
-                                continue;
+                                break;
                         }
+                        n_items += n_children;
 
                         /* If signal subscribers wish to keep it, they can ref it
                          * We won't emit this until we're done building the section
                          * list */
                         section = brisk_apps_section_new(dir);
-                        self->pending_sections = g_slist_append(self->pending_sections, section);
-
-                recurse_root:
-                        /* Descend into the section */
-                        brisk_apps_backend_recurse_root(self, dir, root);
+                        tree->sections = g_slist_prepend(tree->sections, section);
                 } break;
                 case MATEMENU_TREE_ITEM_ENTRY: {
                         MateMenuTreeEntry *entry = MATEMENU_TREE_ENTRY(item);
-                        autofree(GDesktopAppInfo) *info = NULL;
                         const gchar *desktop_file = NULL;
-                        BriskItem *app_item = NULL;
-                        autofree(gchar) *section_id = NULL;
+                        BriskAppsEntry *app_entry = NULL;
 
                         desktop_file = matemenu_tree_entry_get_desktop_file_path(entry);
 
@@ -450,21 +825,18 @@ static void brisk_apps_backend_recurse_root(BriskAppsBackend *self,
                                 break;
                         }
 
-                        section_id = brisk_apps_backend_get_entry_section(directory, entry);
-
-                        /* Must have a desktop file */
-                        info = g_desktop_app_info_new_from_filename(desktop_file);
-                        if (!info) {
-                                break;
-                        }
-                        /* If signal subscribers wish to keep it, they can ref it */
-                        app_item = brisk_apps_item_new(info, section_id);
-                        brisk_backend_item_added(BRISK_BACKEND(self), app_item);
+                        app_entry = g_new0(BriskAppsEntry, 1);
+                        app_entry->desktop_file = g_strdup(desktop_file);
+                        app_entry->section_id = section_id;
+                        g_ptr_array_add(entries, app_entry);
+                        ++n_items;
                 } break;
                 default:
                         break;
                 }
         }
+
+        return n_items;
 }
 
 /**
@@ -0,0 +1,318 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "apps-info-cache.h"
+#include <glib/gstdio.h>
+BRISK_END_PEDANTIC
+
+/**
+ * Two generations are kept: entries used in the current load, and those from
+ * the previous load which haven't been asked for yet.
+ */
+struct BriskAppsInfoCache {
+        GMutex lock;
+        GHashTable *current;  /**<Entries used in this load */
+        GHashTable *previous; /**<Entries from the last load, moved on use */
+        gchar *stamp;         /**<$PATH directory identities and current desktop */
+};
+
+/**
+ * What we know about a file without reading it. Whole second mtimes miss
+ * edits made within the same second, so we keep the nanoseconds, and the
+ * size and inode catch anything replaced with an older timestamp. The mode
+ * and ctime catch permission changes, such as a binary losing its exec bit.
+ */
+typedef struct BriskAppsInfoStat {
+        gint64 mtime; /**<Modification time in nanoseconds, or -1 if missing */
+        gint64 ctime; /**<Status change time in nanoseconds */
+        gint64 size;  /**<Size in bytes */
+        guint64 ino;  /**<Inode number */
+        guint mode;   /**<Type and permission bits */
+} BriskAppsInfoStat;
+
+typedef struct BriskAppsInfoEntry {
+        BriskAppsInfoStat stat;         /**<The desktop file as it was when parsed */
+        gchar *tryexec;                 /**<Where its TryExec program was, if it has one */
+        BriskAppsInfoStat tryexec_stat; /**<That program as it was when parsed */
+        GDesktopAppInfo *info;          /**<NULL if the file could not be shown */
+} BriskAppsInfoEntry;
+
+typedef gchar *gstrv;
+DEF_AUTOFREE(gstrv, g_strfreev)
+DEF_AUTOFREE(gchar, g_free)
+
+static void brisk_apps_info_entry_free(BriskAppsInfoEntry *entry)
+{
+        g_clear_object(&entry->info);
+        g_free(entry->tryexec);
+        g_free(entry);
+}
+
+static GHashTable *brisk_apps_info_cache_table_new(void)
+{
+        return g_hash_table_new_full(g_str_hash,
+                                     g_str_equal,
+                                     g_free,
+                                     (GDestroyNotify)brisk_apps_info_entry_free);
+}
+
+/**
+ * Fill in what identifies the current contents of path. A missing file has
+ * an mtime of -1.
+ */
+static void brisk_apps_info_cache_stat(const gchar *path, BriskAppsInfoStat *out)
+{
+        GStatBuf st = { 0 };
+
+        *out = (BriskAppsInfoStat){ .mtime = -1 };
+        if (g_stat(path, &st) != 0) {
+                return;
+        }
+        out->mtime = (gint64)st.st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) +
+                     (gint64)st.st_mtim.tv_nsec;
+        out->ctime = (gint64)st.st_ctim.tv_sec * G_GINT64_CONSTANT(1000000000) +
+                     (gint64)st.st_ctim.tv_nsec;
+        out->size = (gint64)st.st_size;
+        out->ino = (guint64)st.st_ino;
+        out->mode = (guint)st.st_mode;
+}
+
+static gboolean brisk_apps_info_cache_stat_equal(const BriskAppsInfoStat *a,
+                                                 const BriskAppsInfoStat *b)
+{
+        return a->mtime == b->mtime && a->ctime == b->ctime && a->size == b->size &&
+               a->ino == b->ino && a->mode == b->mode;
+}
+
+/**
+ * Find the file a TryExec refers to. An executable in $PATH wins, as that is
+ * what GLib will find, but failing that we still want the file that isn't
+ * executable (yet) so that we notice when its permissions change.
+ */
+static gchar *brisk_apps_info_cache_find_tryexec(const gchar *tryexec)
+{
+        const gchar *path = NULL;
+        gchar *found = NULL;
+        autofree(gstrv) *dirs = NULL;
+
+        if (g_path_is_absolute(tryexec)) {
+                return g_strdup(tryexec);
+        }
+
+        found = g_find_program_in_path(tryexec);
+        if (found) {
+                return found;
+        }
+
+        path = g_getenv("PATH");
+        if (!path) {
+                return NULL;
+        }
+
+        dirs = g_strsplit(path, G_SEARCHPATH_SEPARATOR_S, -1);
+        for (guint i = 0; dirs[i]; i++) {
+                found = g_build_filename(dirs[i], tryexec, NULL);
+                if (g_file_test(found, G_FILE_TEST_EXISTS)) {
+                        return found;
+                }
+                g_free(found);
+        }
+        return NULL;
+}
+
+/**
+ * Return the TryExec of the desktop file, if any. A file that couldn't be
+ * loaded has to be read again to find it, but that's rare.
+ */
+static gchar *brisk_apps_info_cache_get_tryexec(GDesktopAppInfo *info, const gchar *desktop_file)
+{
+        GKeyFile *file = NULL;
+        gchar *tryexec = NULL;
+
+        if (info) {
+                return g_desktop_app_info_get_string(info, G_KEY_FILE_DESKTOP_KEY_TRY_EXEC);
+        }
+
+        file = g_key_file_new();
+        if (g_key_file_load_from_file(file, desktop_file, G_KEY_FILE_NONE, NULL)) {
+                tryexec = g_key_file_get_string(file,
+                                                G_KEY_FILE_DESKTOP_GROUP,
+                                                G_KEY_FILE_DESKTOP_KEY_TRY_EXEC,
+                                                NULL);
+        }
+        g_key_file_free(file);
+        return tryexec;
+}
+
+/**
+ * Whether the entry still describes the desktop file and its TryExec program
+ */
+static gboolean brisk_apps_info_entry_valid(BriskAppsInfoEntry *entry, const BriskAppsInfoStat *st)
+{
+        BriskAppsInfoStat tryexec = { 0 };
+
+        if (!brisk_apps_info_cache_stat_equal(&entry->stat, st)) {
+                return FALSE;
+        }
+        if (!entry->tryexec) {
+                return TRUE;
+        }
+        brisk_apps_info_cache_stat(entry->tryexec, &tryexec);
+        return brisk_apps_info_cache_stat_equal(&entry->tryexec_stat, &tryexec);
+}
+
+/**
+ * Build a stamp of everything outside of the desktop file that affects
+ * whether we show it. Adding or removing a binary changes the mtime of its
+ * $PATH directory, which is all GLib's TryExec lookup depends on.
+ */
+static gchar *brisk_apps_info_cache_build_stamp(void)
+{
+        GString *stamp = NULL;
+        const gchar *path = NULL;
+        autofree(gstrv) *dirs = NULL;
+
+        stamp = g_string_new(g_getenv("XDG_CURRENT_DESKTOP"));
+
+        path = g_getenv("PATH");
+        if (!path) {
+                return g_string_free(stamp, FALSE);
+        }
+
+        dirs = g_strsplit(path, G_SEARCHPATH_SEPARATOR_S, -1);
+        for (guint i = 0; dirs[i]; i++) {
+                BriskAppsInfoStat st = { 0 };
+
+                brisk_apps_info_cache_stat(dirs[i], &st);
+                g_string_append_printf(stamp,
+                                       ":%s=%" G_GINT64_FORMAT ".%" G_GUINT64_FORMAT,
+                                       dirs[i],
+                                       st.mtime,
+                                       st.ino);
+        }
+
+        return g_string_free(stamp, FALSE);
+}
+
+BriskAppsInfoCache *brisk_apps_info_cache_new(void)
+{
+        BriskAppsInfoCache *self = g_new0(BriskAppsInfoCache, 1);
+
+        g_mutex_init(&self->lock);
+        self->current = brisk_apps_info_cache_table_new();
+        self->previous = brisk_apps_info_cache_table_new();
+        return self;
+}
+
+void brisk_apps_info_cache_free(BriskAppsInfoCache *self)
+{
+        if (!self) {
+                return;
+        }
+        g_hash_table_unref(self->current);
+        g_hash_table_unref(self->previous);
+        g_free(self->stamp);
+        g_mutex_clear(&self->lock);
+        g_free(self);
+}
+
+gboolean brisk_apps_info_cache_begin(BriskAppsInfoCache *self)
+{
+        gchar *stamp = brisk_apps_info_cache_build_stamp();
+        gboolean flushed = FALSE;
+
+        g_mutex_lock(&self->lock);
+
+        /* Anything not used in the last load is gone for good */
+        g_hash_table_unref(self->previous);
+        self->previous = self->current;
+        self->current = brisk_apps_info_cache_table_new();
+
+        /* Environment changed, so every cached decision is invalid */
+        if (g_strcmp0(stamp, self->stamp) != 0) {
+                g_hash_table_remove_all(self->previous);
+                flushed = TRUE;
+        }
+        g_free(self->stamp);
+        self->stamp = stamp;
+
+        g_mutex_unlock(&self->lock);
+        return flushed;
+}
+
+GDesktopAppInfo *brisk_apps_info_cache_lookup(BriskAppsInfoCache *self, const gchar *desktop_file)
+{
+        BriskAppsInfoEntry *entry = NULL;
+        GDesktopAppInfo *info = NULL;
+        gpointer key = NULL;
+        BriskAppsInfoStat st = { 0 };
+        autofree(gchar) *tryexec = NULL;
+
+        brisk_apps_info_cache_stat(desktop_file, &st);
+
+        g_mutex_lock(&self->lock);
+
+        entry = g_hash_table_lookup(self->current, desktop_file);
+        if (!entry && g_hash_table_lookup_extended(self->previous,
+                                                   desktop_file,
+                                                   &key,
+                                                   (gpointer *)&entry)) {
+                /* Promote into the current generation */
+                g_hash_table_steal(self->previous, key);
+                g_hash_table_insert(self->current, key, entry);
+        }
+
+        if (entry && brisk_apps_info_entry_valid(entry, &st)) {
+                info = entry->info ? g_object_ref(entry->info) : NULL;
+                g_mutex_unlock(&self->lock);
+                return info;
+        }
+
+        g_mutex_unlock(&self->lock);
+
+        /* Parse outside of the lock, this is where TryExec hits $PATH */
+        entry = g_new0(BriskAppsInfoEntry, 1);
+        entry->stat = st;
+        entry->info = g_desktop_app_info_new_from_filename(desktop_file);
+        info = entry->info ? g_object_ref(entry->info) : NULL;
+
+        tryexec = brisk_apps_info_cache_get_tryexec(entry->info, desktop_file);
+        if (tryexec) {
+                entry->tryexec = brisk_apps_info_cache_find_tryexec(tryexec);
+        }
+        if (entry->tryexec) {
+                brisk_apps_info_cache_stat(entry->tryexec, &entry->tryexec_stat);
+        }
+
+        g_mutex_lock(&self->lock);
+        g_hash_table_replace(self->current, g_strdup(desktop_file), entry);
+        g_mutex_unlock(&self->lock);
+
+        return info;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
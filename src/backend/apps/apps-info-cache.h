@@ -0,0 +1,58 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <gio/gdesktopappinfo.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * BriskAppsInfoCache remembers the GDesktopAppInfo (or the lack of one, i.e.
+ * a failed TryExec) for every desktop file across reloads, so that unchanged
+ * files are neither parsed nor probed against $PATH again. It also decides
+ * when the kept menu trees have to be thrown away, see
+ * brisk_apps_info_cache_begin().
+ */
+typedef struct BriskAppsInfoCache BriskAppsInfoCache;
+
+BriskAppsInfoCache *brisk_apps_info_cache_new(void);
+void brisk_apps_info_cache_free(BriskAppsInfoCache *cache);
+
+/**
+ * Start a new load. Entries unused since the previous load are dropped, and
+ * everything is flushed if $PATH or the current desktop changed. Returns TRUE
+ * when flushed, in which case any visibility decisions made elsewhere, such
+ * as by libmate-menu, are just as stale.
+ */
+gboolean brisk_apps_info_cache_begin(BriskAppsInfoCache *cache);
+
+/**
+ * Return a new reference to the GDesktopAppInfo for the given file, or NULL
+ * if it cannot be shown. Safe to call from multiple threads.
+ */
+GDesktopAppInfo *brisk_apps_info_cache_lookup(BriskAppsInfoCache *cache, const gchar *desktop_file);
+
+G_END_DECLS
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -37,7 +37,8 @@ struct _BriskAppsItemClass {
 struct _BriskAppsItem {
         BriskItem parent;
         GDesktopAppInfo *info;
-        gchar *section_id;
+        const gchar *id;     /**<Interned desktop ID */
+        GSList *section_ids; /**<Interned IDs of every section we belong to */
 };
 
 G_DEFINE_TYPE(BriskAppsItem, brisk_apps_item, BRISK_TYPE_ITEM)
@@ -54,6 +55,8 @@ static const char *brisk_apps_item_get_backend_id(BriskItem *item);
 static gboolean brisk_apps_item_matches_search(BriskItem *item, gchar *term);
 static gboolean brisk_apps_item_launch(BriskItem *item, GAppLaunchContext *context);
 static gchar *brisk_apps_item_get_uri(BriskItem *item);
+static const gchar *brisk_apps_item_get_executable(BriskItem *item);
+static gsize brisk_apps_item_get_memory_size(BriskItem *item);
 
 static void brisk_apps_item_set_property(GObject *object, guint id, const GValue *value,
                                          GParamSpec *spec)
@@ -62,11 +65,21 @@ static void brisk_apps_item_set_property(GObject *object, guint id, const GValue
 
         switch (id) {
         case PROP_INFO:
+                g_clear_object(&self->info);
                 self->info = g_value_dup_object(value);
+                if (self->info) {
+                        const gchar *id = g_app_info_get_id(G_APP_INFO(self->info));
+
+                        /* Files outside the XDG applications dirs have no ID, and
+                         * would otherwise all share NULL and be merged into one */
+                        if (!id) {
+                                id = g_desktop_app_info_get_filename(self->info);
+                        }
+                        self->id = g_intern_string(id);
+                }
                 break;
         case PROP_SECTION_ID:
-                g_clear_pointer(&self->section_id, g_free);
-                self->section_id = g_value_dup_string(value);
+                brisk_apps_item_add_section(self, g_value_get_string(value));
                 break;
         default:
                 G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, spec);
@@ -83,7 +96,7 @@ static void brisk_apps_item_get_property(GObject *object, guint id, GValue *valu
                 g_value_set_pointer(value, self->info);
                 break;
         case PROP_SECTION_ID:
-                g_value_set_string(value, self->section_id);
+                g_value_set_string(value, self->section_ids ? self->section_ids->data : NULL);
                 break;
         default:
                 G_OBJECT_WARN_INVALID_PROPERTY_ID(object, id, spec);
@@ -101,7 +114,7 @@ static void brisk_apps_item_dispose(GObject *obj)
         BriskAppsItem *self = BRISK_APPS_ITEM(obj);
 
         g_clear_object(&self->info);
-        g_clear_pointer(&self->section_id, g_free);
+        g_clear_pointer(&self->section_ids, g_slist_free);
 
         G_OBJECT_CLASS(brisk_apps_item_parent_class)->dispose(obj);
 }
@@ -126,6 +139,8 @@ static void brisk_apps_item_class_init(BriskAppsItemClass *klazz)
         i_class->matches_search = brisk_apps_item_matches_search;
         i_class->launch = brisk_apps_item_launch;
         i_class->get_uri = brisk_apps_item_get_uri;
+        i_class->get_memory_size = brisk_apps_item_get_memory_size;
+        i_class->get_executable = brisk_apps_item_get_executable;
 
         /* gobject vtable hookup */
         obj_class->dispose = brisk_apps_item_dispose;
@@ -140,7 +155,7 @@ static void brisk_apps_item_class_init(BriskAppsItemClass *klazz)
         obj_properties[PROP_SECTION_ID] =
             g_param_spec_string("section-id",
                                 "The section ID",
-                                "Parent section ID",
+                                "Initial parent section ID",
                                 NULL,
                                 G_PARAM_CONSTRUCT | G_PARAM_READWRITE);
         g_object_class_install_properties(obj_class, N_PROPS, obj_properties);
@@ -158,7 +173,7 @@ static void brisk_apps_item_init(__brisk_unused__ BriskAppsItem *self)
 static const gchar *brisk_apps_item_get_id(BriskItem *item)
 {
         BriskAppsItem *self = BRISK_APPS_ITEM(item);
-        return g_app_info_get_id(G_APP_INFO(self->info));
+        return self->id;
 }
 
 static const gchar *brisk_apps_item_get_name(BriskItem *item)
@@ -187,7 +202,7 @@ static const GIcon *brisk_apps_item_get_icon(BriskItem *item)
 
 static const char *brisk_apps_item_get_backend_id(__brisk_unused__ BriskItem *item)
 {
-        return "apps";
+        return g_intern_static_string("apps");
 }
 
 __brisk_pure__ static gboolean brisk_apps_array_contains(const gchar **fields, size_t n_fields,
@@ -271,25 +286,118 @@ static gchar *brisk_apps_item_get_uri(BriskItem *item)
         return g_filename_to_uri(desktop_fpath, NULL, NULL);
 }
 
+/**
+ * Already parsed from the Exec line, so this is free to call
+ */
+static const gchar *brisk_apps_item_get_executable(BriskItem *item)
+{
+        BriskAppsItem *self = BRISK_APPS_ITEM(item);
+        return g_app_info_get_executable(G_APP_INFO(self->info));
+}
+
+static inline gsize brisk_apps_item_string_size(const gchar *str)
+{
+        return str ? strlen(str) + 1 : 0;
+}
+
+/**
+ * Our name and summary come from the GDesktopAppInfo, so on top of those we
+ * account for the rest of the parsed desktop file that it keeps around.
+ */
+static gsize brisk_apps_item_get_memory_size(BriskItem *item)
+{
+        BriskAppsItem *self = BRISK_APPS_ITEM(item);
+        GTypeQuery query = { 0 };
+        const gchar *const *keywords = NULL;
+        gsize size = 0;
+
+        size = BRISK_ITEM_CLASS(brisk_apps_item_parent_class)->get_memory_size(item);
+        size += g_slist_length(self->section_ids) * sizeof(GSList);
+
+        if (!self->info) {
+                return size;
+        }
+
+        g_type_query(G_OBJECT_TYPE(self->info), &query);
+        size += query.instance_size;
+        size += brisk_apps_item_string_size(g_desktop_app_info_get_filename(self->info));
+        size += brisk_apps_item_string_size(g_desktop_app_info_get_generic_name(self->info));
+        size += brisk_apps_item_string_size(g_desktop_app_info_get_categories(self->info));
+        size += brisk_apps_item_string_size(g_app_info_get_executable(G_APP_INFO(self->info)));
+        size += brisk_apps_item_string_size(g_app_info_get_commandline(G_APP_INFO(self->info)));
+
+        keywords = g_desktop_app_info_get_keywords(self->info);
+        for (guint i = 0; keywords && keywords[i]; i++) {
+                size += sizeof(gchar *) + brisk_apps_item_string_size(keywords[i]);
+        }
+
+        return size;
+}
+
 /**
  * brisk_apps_item_new:
  *
  * Return a new BriskAppsItem for the given desktop file
  */
-BriskItem *brisk_apps_item_new(GDesktopAppInfo *info, gchar *section_id)
+BriskItem *brisk_apps_item_new(GDesktopAppInfo *info, const gchar *section_id)
 {
         return g_object_new(BRISK_TYPE_APPS_ITEM, "info", info, "section-id", section_id, NULL);
 }
 
 /**
- * brisk_apps_item_get_section_id:
+ * brisk_apps_item_add_section:
+ *
+ * Private API for the AppsBackend to record that the same desktop ID was
+ * found in another section, so that only one item is emitted per ID.
+ */
+void brisk_apps_item_add_section(BriskAppsItem *self, const gchar *section_id)
+{
+        const gchar *id = NULL;
+
+        if (!section_id) {
+                return;
+        }
+
+        id = g_intern_string(section_id);
+        if (g_slist_find(self->section_ids, id)) {
+                return;
+        }
+        self->section_ids = g_slist_append(self->section_ids, (gpointer)id);
+}
+
+/**
+ * brisk_apps_item_merge_sections:
+ *
+ * Add all of the section memberships from other to self
+ */
+void brisk_apps_item_merge_sections(BriskAppsItem *self, BriskAppsItem *other)
+{
+        for (GSList *elem = other->section_ids; elem; elem = elem->next) {
+                brisk_apps_item_add_section(self, elem->data);
+        }
+}
+
+/**
+ * brisk_apps_item_in_section:
  *
  * Private API for the AppsSection to determine if a child belongs to
- * it or not.
+ * it or not. The section ID must be interned.
+ */
+gboolean brisk_apps_item_in_section(BriskAppsItem *self, const gchar *section_id)
+{
+        return section_id && g_slist_find(self->section_ids, section_id) != NULL;
+}
+
+/**
+ * brisk_apps_item_get_info:
+ *
+ * Private API for the AppsBackend to build context actions without having
+ * to parse the desktop file again
+ * @note The returned info is owned by the item
  */
-const gchar *brisk_apps_item_get_section_id(BriskAppsItem *self)
+GDesktopAppInfo *brisk_apps_item_get_info(BriskAppsItem *self)
 {
-        return (const gchar *)self->section_id;
+        return self->info;
 }
 
 /*
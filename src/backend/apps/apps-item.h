@@ -33,9 +33,12 @@ typedef struct _BriskAppsItemClass BriskAppsItemClass;
 
 GType brisk_apps_item_get_type(void);
 
-BriskItem *brisk_apps_item_new(GDesktopAppInfo *info, gchar *section_id);
+BriskItem *brisk_apps_item_new(GDesktopAppInfo *info, const gchar *section_id);
 
-const gchar *brisk_apps_item_get_section_id(BriskAppsItem *item);
+void brisk_apps_item_add_section(BriskAppsItem *item, const gchar *section_id);
+void brisk_apps_item_merge_sections(BriskAppsItem *item, BriskAppsItem *other);
+gboolean brisk_apps_item_in_section(BriskAppsItem *item, const gchar *section_id);
+GDesktopAppInfo *brisk_apps_item_get_info(BriskAppsItem *item);
 
 G_END_DECLS
 
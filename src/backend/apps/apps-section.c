@@ -36,7 +36,7 @@ struct _BriskAppsSectionClass {
 struct _BriskAppsSection {
         BriskSection parent;
 
-        gchar *id;
+        const gchar *id; /**<Interned section ID */
         gchar *name;
         GIcon *icon;
 };
@@ -44,6 +44,7 @@ struct _BriskAppsSection {
 G_DEFINE_TYPE(BriskAppsSection, brisk_apps_section, BRISK_TYPE_SECTION)
 
 DEF_AUTOFREE(GFile, g_object_unref)
+DEF_AUTOFREE(gchar, g_free)
 
 /**
  * Basic subclassing
@@ -71,18 +72,20 @@ static GIcon *brisk_apps_section_create_path_icon(const gchar *path)
 static void brisk_apps_section_update_directory(BriskAppsSection *self,
                                                 MateMenuTreeDirectory *directory)
 {
+        autofree(gchar) *id = NULL;
+        const gchar *icon = NULL;
+
         g_clear_object(&self->icon);
-        g_clear_pointer(&self->id, g_free);
         g_clear_pointer(&self->name, g_free);
-        const gchar *icon = NULL;
+        self->id = NULL;
 
         if (!directory) {
                 return;
         }
 
         /* Set our ID and name */
-        self->id =
-            g_strdup_printf("%s.mate-directory", matemenu_tree_directory_get_menu_id(directory));
+        id = g_strdup_printf("%s.mate-directory", matemenu_tree_directory_get_menu_id(directory));
+        self->id = g_intern_string(id);
         self->name = g_strdup(matemenu_tree_directory_get_name(directory));
 
         icon = matemenu_tree_directory_get_icon(directory);
@@ -139,7 +142,6 @@ static void brisk_apps_section_dispose(GObject *obj)
         BriskAppsSection *self = BRISK_APPS_SECTION(obj);
 
         g_clear_object(&self->icon);
-        g_clear_pointer(&self->id, g_free);
         g_clear_pointer(&self->name, g_free);
 
         G_OBJECT_CLASS(brisk_apps_section_parent_class)->dispose(obj);
@@ -187,7 +189,7 @@ static void brisk_apps_section_init(__brisk_unused__ BriskAppsSection *self)
 static const gchar *brisk_apps_section_get_id(BriskSection *section)
 {
         BriskAppsSection *self = BRISK_APPS_SECTION(section);
-        return (const gchar *)self->id;
+        return self->id;
 }
 
 static const gchar *brisk_apps_section_get_name(BriskSection *section)
@@ -204,17 +206,17 @@ static const GIcon *brisk_apps_section_get_icon(BriskSection *section)
 
 static const gchar *brisk_apps_section_get_backend_id(__brisk_unused__ BriskSection *item)
 {
-        return "apps";
+        return g_intern_static_string("apps");
 }
 
 /**
- * Long story short, if the section ID matches, we can show it.
+ * Long story short, if the item is a member of our section, we can show it.
+ * All IDs are interned so a pointer comparison is sufficient.
  */
 static gboolean brisk_apps_section_can_show_item(BriskSection *section, BriskItem *item)
 {
         /* We only know how to handle our items */
         BriskAppsItem *apps_item = NULL;
-        const gchar *section_id = NULL;
         BriskAppsSection *self = BRISK_APPS_SECTION(section);
 
         if (G_UNLIKELY(item == NULL) || G_UNLIKELY(!BRISK_IS_APPS_ITEM(item))) {
@@ -222,11 +224,7 @@ static gboolean brisk_apps_section_can_show_item(BriskSection *section, BriskIte
         }
 
         apps_item = BRISK_APPS_ITEM(item);
-        section_id = brisk_apps_item_get_section_id(apps_item);
-        if (section_id && g_str_equal(section_id, self->id)) {
-                return TRUE;
-        }
-        return FALSE;
+        return brisk_apps_item_in_section(apps_item, self->id);
 }
 
 /**
@@ -27,6 +27,10 @@ enum { BACKEND_SIGNAL_ITEM_ADDED = 0,
        BACKEND_SIGNAL_INVALIDATE_FILTER,
        BACKEND_SIGNAL_HIDE_MENU,
        BACKEND_SIGNAL_RESET,
+       BACKEND_SIGNAL_LOAD_STARTED,
+       BACKEND_SIGNAL_LOAD_FINISHED,
+       BACKEND_SIGNAL_ACTIONS_CHANGED,
+       BACKEND_SIGNAL_ITEM_CHANGED,
        N_SIGNALS };
 
 static guint backend_signals[N_SIGNALS] = { 0 };
@@ -60,7 +64,8 @@ static void brisk_backend_class_init(BriskBackendClass *klazz)
          * @backend: The backend that created the item
          * @item: The newly available item
          *
-         * Used to notify the frontend that a new item is available for consumption
+         * Used to notify the frontend that a new item is available for consumption.
+         * Each item ID is only emitted once per backend until the next reset.
          */
         backend_signals[BACKEND_SIGNAL_ITEM_ADDED] =
             g_signal_new("item-added",
@@ -181,6 +186,85 @@ static void brisk_backend_class_init(BriskBackendClass *klazz)
                          NULL,
                          G_TYPE_NONE,
                          0);
+
+        /**
+         * BriskBackend::load-started
+         * @backend: The backend that is now loading
+         *
+         * Emitted by source backends before any items are emitted for a
+         * load or reload. A new load may start before the last finished, in
+         * which case the earlier load is abandoned.
+         */
+        backend_signals[BACKEND_SIGNAL_LOAD_STARTED] =
+            g_signal_new("load-started",
+                         BRISK_TYPE_BACKEND,
+                         G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+                         G_STRUCT_OFFSET(BriskBackendClass, load_started),
+                         NULL,
+                         NULL,
+                         NULL,
+                         G_TYPE_NONE,
+                         0);
+
+        /**
+         * BriskBackend::load-finished
+         * @backend: The backend that finished loading
+         * @stats: (type BriskBackendLoadStats): Counts and timings for the load
+         *
+         * Emitted by source backends once every item and section for the load
+         * has been emitted, so frontends may defer expensive work until then
+         */
+        backend_signals[BACKEND_SIGNAL_LOAD_FINISHED] =
+            g_signal_new("load-finished",
+                         BRISK_TYPE_BACKEND,
+                         G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+                         G_STRUCT_OFFSET(BriskBackendClass, load_finished),
+                         NULL,
+                         NULL,
+                         NULL,
+                         G_TYPE_NONE,
+                         1,
+                         G_TYPE_POINTER);
+
+        /**
+         * BriskBackend::actions-changed
+         * @backend: The backend whose actions changed
+         * @id: (nullable): The affected item's ID, or NULL for every item
+         *
+         * Used to notify the frontend that any context menu it built from
+         * get_item_actions for the item is now stale
+         */
+        backend_signals[BACKEND_SIGNAL_ACTIONS_CHANGED] =
+            g_signal_new("actions-changed",
+                         BRISK_TYPE_BACKEND,
+                         G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+                         G_STRUCT_OFFSET(BriskBackendClass, actions_changed),
+                         NULL,
+                         NULL,
+                         NULL,
+                         G_TYPE_NONE,
+                         1,
+                         G_TYPE_STRING);
+
+        /**
+         * BriskBackend::item-changed
+         * @backend: The backend that changed the item
+         * @id: The affected item's ID
+         *
+         * Used to notify the frontend that a single item's filter or sort
+         * position may have changed, without refiltering every item
+         */
+        backend_signals[BACKEND_SIGNAL_ITEM_CHANGED] =
+            g_signal_new("item-changed",
+                         BRISK_TYPE_BACKEND,
+                         G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+                         G_STRUCT_OFFSET(BriskBackendClass, item_changed),
+                         NULL,
+                         NULL,
+                         NULL,
+                         G_TYPE_NONE,
+                         1,
+                         G_TYPE_STRING);
 }
 
 /**
@@ -269,6 +353,51 @@ void brisk_backend_reset(BriskBackend *self)
         g_signal_emit(self, backend_signals[BACKEND_SIGNAL_RESET], 0);
 }
 
+/**
+ * brisk_backend_load_started:
+ *
+ * Implementations may use this method to emit the signal load-started
+ */
+void brisk_backend_load_started(BriskBackend *self)
+{
+        g_assert(self != NULL);
+        g_signal_emit(self, backend_signals[BACKEND_SIGNAL_LOAD_STARTED], 0);
+}
+
+/**
+ * brisk_backend_load_finished:
+ *
+ * Implementations may use this method to emit the signal load-finished
+ */
+void brisk_backend_load_finished(BriskBackend *self, const BriskBackendLoadStats *stats)
+{
+        g_assert(self != NULL);
+        g_assert(stats != NULL);
+        g_signal_emit(self, backend_signals[BACKEND_SIGNAL_LOAD_FINISHED], 0, stats);
+}
+
+/**
+ * brisk_backend_actions_changed:
+ *
+ * Implementations may use this method to emit the signal actions-changed
+ */
+void brisk_backend_actions_changed(BriskBackend *self, const gchar *id)
+{
+        g_assert(self != NULL);
+        g_signal_emit(self, backend_signals[BACKEND_SIGNAL_ACTIONS_CHANGED], 0, id);
+}
+
+/**
+ * brisk_backend_item_changed:
+ *
+ * Implementations may use this method to emit the signal item-changed
+ */
+void brisk_backend_item_changed(BriskBackend *self, const gchar *id)
+{
+        g_assert(self != NULL);
+        g_signal_emit(self, backend_signals[BACKEND_SIGNAL_ITEM_CHANGED], 0, id);
+}
+
 /**
  * brisk_backend_get_flags:
  *
@@ -286,7 +415,7 @@ unsigned int brisk_backend_get_flags(BriskBackend *backend)
  * brisk_backend_get_id:
  *
  * Return the unique ID for the backend
- * @note This string is owned by the backend and must not be freed
+ * @note This string is interned, and may be compared by pointer
  */
 const gchar *brisk_backend_get_id(BriskBackend *backend)
 {
@@ -28,15 +28,31 @@ typedef enum {
         BRISK_BACKEND_SOURCE = 1 << 1,   /**<Provides data which must be loaded */
 } BriskBackendFlags;
 
+/**
+ * Statistics for a single load of a source backend, passed with load-finished.
+ * All times are in microseconds.
+ */
+typedef struct BriskBackendLoadStats {
+        guint n_items;     /**<Number of items emitted */
+        guint n_sections;  /**<Number of sections emitted */
+        gint64 tree_time;  /**<Time spent building menu trees */
+        gint64 parse_time; /**<Time spent parsing desktop files */
+        gint64 emit_time;  /**<Time spent emitting to the frontends */
+        gint64 total_time; /**<Wall clock time from load-started to load-finished */
+} BriskBackendLoadStats;
+
 struct _BriskBackendClass {
         GObjectClass parent_class;
 
-        /* All plugins must implement these methods */
+        /* All plugins must implement these methods. get_id must return an
+         * interned string (see g_intern_string) */
         unsigned int (*get_flags)(BriskBackend *);
         const gchar *(*get_id)(BriskBackend *);
         const gchar *(*get_display_name)(BriskBackend *);
 
-        /* Optional method for providing context menu items */
+        /* Optional method for providing context menu items. Frontends may
+         * cache the result per item, along with the group the actions were
+         * added to, until actions-changed or reset is emitted. */
         GMenu *(*get_item_actions)(BriskBackend *, BriskItem *, GActionGroup *);
 
         /* All plugins given an opportunity to load later in life */
@@ -50,8 +66,12 @@ struct _BriskBackendClass {
         void (*invalidate_filter)(BriskBackend *backend);
         void (*hide_menu)(BriskBackend *backend);
         void (*reset)(BriskBackend *backend);
+        void (*load_started)(BriskBackend *backend);
+        void (*load_finished)(BriskBackend *backend, const BriskBackendLoadStats *stats);
+        void (*actions_changed)(BriskBackend *backend, const gchar *id);
+        void (*item_changed)(BriskBackend *backend, const gchar *id);
 
-        gpointer padding[12];
+        gpointer padding[8];
 };
 
 /**
@@ -93,6 +113,10 @@ void brisk_backend_section_removed(BriskBackend *backend, const gchar *id);
 void brisk_backend_invalidate_filter(BriskBackend *backend);
 void brisk_backend_hide_menu(BriskBackend *backend);
 void brisk_backend_reset(BriskBackend *backend);
+void brisk_backend_load_started(BriskBackend *backend);
+void brisk_backend_load_finished(BriskBackend *backend, const BriskBackendLoadStats *stats);
+void brisk_backend_actions_changed(BriskBackend *backend, const gchar *id);
+void brisk_backend_item_changed(BriskBackend *backend, const gchar *id);
 
 G_END_DECLS
 
@@ -21,15 +21,19 @@ BRISK_END_PEDANTIC
 
 G_DEFINE_TYPE(BriskFavouritesBackend, brisk_favourites_backend, BRISK_TYPE_BACKEND)
 
+/**
+ * Pins, unpins and moves made in quick succession are written back to
+ * GSettings together once things have been quiet for this long (ms)
+ */
+#define FAVOURITES_APPLY_DELAY 500
+
 /* Helper for gsettings */
 typedef gchar *gstrv;
 DEF_AUTOFREE(gstrv, g_strfreev)
 
-static inline void _g_array_clean(GArray *array)
-{
-        g_array_free(array, TRUE);
-}
-DEF_AUTOFREE(GArray, _g_array_clean)
+DEF_AUTOFREE(GSimpleAction, g_object_unref)
+DEF_AUTOFREE(GPtrArray, g_ptr_array_unref)
+DEF_AUTOFREE(GHashTable, g_hash_table_unref)
 
 static gboolean brisk_favourites_backend_load(BriskBackend *backend);
 static void brisk_favourites_backend_pin_item(GSimpleAction *action, GVariant *parameter,
@@ -47,7 +51,7 @@ static unsigned int brisk_favourites_backend_get_flags(__brisk_unused__ BriskBac
 
 static const gchar *brisk_favourites_backend_get_id(__brisk_unused__ BriskBackend *backend)
 {
-        return "favourites";
+        return g_intern_static_string("favourites");
 }
 
 static const gchar *brisk_favourites_backend_get_display_name(
@@ -56,30 +60,55 @@ static const gchar *brisk_favourites_backend_get_display_name(
         return _("Favourites");
 }
 
+/**
+ * brisk_favourites_backend_item_action:
+ *
+ * Create an action bound to the given item. Frontends hold onto the action
+ * group for as long as they cache the item's menu, so each item gets its
+ * own actions rather than sharing some notion of the "active" item.
+ */
+GSimpleAction *brisk_favourites_backend_item_action(BriskFavouritesBackend *self,
+                                                    BriskItem *item, const gchar *name,
+                                                    GCallback callback)
+{
+        GSimpleAction *action = g_simple_action_new(name, NULL);
+
+        g_object_set_data_full(G_OBJECT(action), "__item", g_object_ref(item), g_object_unref);
+        g_signal_connect(action, "activate", callback, self);
+        return action;
+}
+
 static GMenu *brisk_favourites_backend_get_item_actions(BriskBackend *backend, BriskItem *item,
                                                         GActionGroup *group)
 {
         GMenu *ret = NULL;
         BriskFavouritesBackend *self = BRISK_FAVOURITES_BACKEND(backend);
-
-        g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(self->action_add));
-        g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(self->action_remove));
-
-        self->active_item = item;
+        autofree(GSimpleAction) *action = NULL;
 
         ret = g_menu_new();
 
         if (brisk_favourites_backend_is_pinned(self, item)) {
+                action = brisk_favourites_backend_item_action(
+                    self,
+                    item,
+                    "favourites.unpin",
+                    G_CALLBACK(brisk_favourites_backend_unpin_item));
                 g_menu_append(ret,
                               _("Unpin from favourites menu"),
                               "brisk-context-items.favourites.unpin");
         } else {
+                action = brisk_favourites_backend_item_action(
+                    self,
+                    item,
+                    "favourites.pin",
+                    G_CALLBACK(brisk_favourites_backend_pin_item));
                 g_menu_append(ret,
                               _("Pin to favourites menu"),
                               "brisk-context-items.favourites.pin");
         }
+        g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(action));
 
-        brisk_favourites_backend_menu_desktop(self, ret, group);
+        brisk_favourites_backend_menu_desktop(self, item, ret, group);
 
         return ret;
 }
@@ -92,12 +121,18 @@ static GMenu *brisk_favourites_backend_get_item_actions(BriskBackend *backend, B
 static void brisk_favourites_backend_dispose(GObject *obj)
 {
         BriskFavouritesBackend *self = BRISK_FAVOURITES_BACKEND(obj);
-        g_clear_object(&self->action_add);
-        g_clear_object(&self->action_remove);
-        g_clear_object(&self->action_add_desktop);
-        g_clear_object(&self->action_remove_desktop);
+        brisk_favourites_backend_dispose_desktop(self);
+
+        /* Don't lose a pending write */
+        if (self->apply_id > 0) {
+                g_source_remove(self->apply_id);
+                self->apply_id = 0;
+                g_settings_apply(self->settings);
+        }
+
         g_clear_object(&self->settings);
         g_clear_pointer(&self->favourites, g_hash_table_unref);
+        g_clear_pointer(&self->favourites_order, g_ptr_array_unref);
         G_OBJECT_CLASS(brisk_favourites_backend_parent_class)->dispose(obj);
 }
 
@@ -123,22 +158,222 @@ static void brisk_favourites_backend_class_init(BriskFavouritesBackendClass *kla
 }
 
 /**
- * Handle changes to the favourites schema. We'll reset our table and restore the
- * entries and retain the order within the list, which will come in useful in
- * future when we want to enable reordering of entries.
+ * Refresh the stored position of every ID between start and end inclusive.
+ * Their rows have shifted, so the frontends need to resort each of them.
+ */
+static void brisk_favourites_backend_reindex(BriskFavouritesBackend *self, guint start,
+                                             guint end)
+{
+        for (guint i = start; i <= end && i < self->favourites_order->len; i++) {
+                gpointer id = g_ptr_array_index(self->favourites_order, i);
+
+                g_hash_table_insert(self->favourites, id, GUINT_TO_POINTER(i));
+                brisk_backend_item_changed(BRISK_BACKEND(self), id);
+        }
+}
+
+/**
+ * Let the frontends know this one item needs refiltering, and that its
+ * context menu now has the wrong pin/unpin entry
+ */
+static void brisk_favourites_backend_notify(BriskFavouritesBackend *self, const gchar *id)
+{
+        brisk_backend_item_changed(BRISK_BACKEND(self), id);
+        brisk_backend_actions_changed(BRISK_BACKEND(self), id);
+}
+
+static gboolean brisk_favourites_backend_apply(BriskFavouritesBackend *self)
+{
+        self->apply_id = 0;
+        g_settings_apply(self->settings);
+        return G_SOURCE_REMOVE;
+}
+
+/**
+ * Write the store back to the delayed settings, and schedule the real write
+ */
+static void brisk_favourites_backend_store(BriskFavouritesBackend *self)
+{
+        const gchar **ids = g_new0(const gchar *, self->favourites_order->len + 1);
+
+        /* IDs are interned, so only the vector itself is ours */
+        for (guint i = 0; i < self->favourites_order->len; i++) {
+                ids[i] = g_ptr_array_index(self->favourites_order, i);
+        }
+
+        g_settings_set_strv(self->settings, "favourites", ids);
+        g_free(ids);
+
+        if (self->apply_id == 0) {
+                self->apply_id = g_timeout_add(FAVOURITES_APPLY_DELAY,
+                                               (GSourceFunc)brisk_favourites_backend_apply,
+                                               self);
+        }
+}
+
+/**
+ * brisk_favourites_backend_insert:
+ *
+ * Pin the ID at the given position, or at the end if position is negative.
+ * Returns FALSE if it was already pinned.
+ */
+gboolean brisk_favourites_backend_insert(BriskFavouritesBackend *self, const gchar *id,
+                                         gint position)
+{
+        guint index = 0;
+
+        id = g_intern_string(id);
+        if (g_hash_table_contains(self->favourites, id)) {
+                return FALSE;
+        }
+
+        index = self->favourites_order->len;
+        if (position >= 0 && (guint)position < index) {
+                index = (guint)position;
+        }
+
+        g_ptr_array_insert(self->favourites_order, (gint)index, (gpointer)id);
+        brisk_favourites_backend_reindex(self, index, self->favourites_order->len - 1);
+        brisk_favourites_backend_store(self);
+        brisk_backend_actions_changed(BRISK_BACKEND(self), id);
+        return TRUE;
+}
+
+/**
+ * brisk_favourites_backend_remove:
+ *
+ * Unpin the ID, returning FALSE if it wasn't pinned
+ */
+gboolean brisk_favourites_backend_remove(BriskFavouritesBackend *self, const gchar *id)
+{
+        gpointer val = NULL;
+        guint index = 0;
+
+        id = g_intern_string(id);
+        if (!g_hash_table_lookup_extended(self->favourites, id, NULL, &val)) {
+                return FALSE;
+        }
+
+        index = GPOINTER_TO_UINT(val);
+        g_ptr_array_remove_index(self->favourites_order, index);
+        g_hash_table_remove(self->favourites, id);
+        brisk_favourites_backend_reindex(self, index, self->favourites_order->len - 1);
+        brisk_favourites_backend_store(self);
+        brisk_favourites_backend_notify(self, id);
+        return TRUE;
+}
+
+/**
+ * brisk_favourites_backend_move:
+ *
+ * Move a pinned ID to the given position, or the end if position is
+ * negative. Only the items between the old and new positions shift, so
+ * only those need resorting. Returns FALSE if nothing moved.
+ */
+gboolean brisk_favourites_backend_move(BriskFavouritesBackend *self, const gchar *id,
+                                       gint position)
+{
+        gpointer val = NULL;
+        guint from = 0;
+        guint to = 0;
+
+        id = g_intern_string(id);
+        if (!g_hash_table_lookup_extended(self->favourites, id, NULL, &val)) {
+                return FALSE;
+        }
+
+        from = GPOINTER_TO_UINT(val);
+        to = self->favourites_order->len - 1;
+        if (position >= 0 && (guint)position < to) {
+                to = (guint)position;
+        }
+        if (from == to) {
+                return FALSE;
+        }
+
+        g_ptr_array_remove_index(self->favourites_order, from);
+        g_ptr_array_insert(self->favourites_order, (gint)to, (gpointer)id);
+        brisk_favourites_backend_reindex(self, MIN(from, to), MAX(from, to));
+        brisk_favourites_backend_store(self);
+        return TRUE;
+}
+
+/**
+ * Whether the stored list is exactly what we already have
+ */
+static gboolean brisk_favourites_backend_matches(BriskFavouritesBackend *self, gchar **favs)
+{
+        guint len = favs ? g_strv_length(favs) : 0;
+
+        if (len != self->favourites_order->len) {
+                return FALSE;
+        }
+        for (guint i = 0; i < len; i++) {
+                if (!g_str_equal(favs[i], g_ptr_array_index(self->favourites_order, i))) {
+                        return FALSE;
+                }
+        }
+        return TRUE;
+}
+
+/**
+ * Handle changes to the favourites schema. Our own writes come straight
+ * back to us here and match the store already, so there's nothing to do.
+ * Anything else came from outside, so we adopt the new list and only
+ * notify about the IDs that were added, removed or moved.
  */
 static void brisk_favourites_backend_changed(GSettings *settings, const gchar *key,
                                              BriskFavouritesBackend *self)
 {
         autofree(gstrv) *favs = g_settings_get_strv(settings, key);
-        g_hash_table_remove_all(self->favourites);
+        autofree(GPtrArray) *old_order = NULL;
+        autofree(GHashTable) *old = NULL;
+        GHashTableIter iter;
+        gpointer id = NULL;
+        gpointer val = NULL;
 
-        if (!favs) {
+        if (self->favourites && brisk_favourites_backend_matches(self, favs)) {
                 return;
         }
 
-        for (guint i = 0; i < g_strv_length(favs); i++) {
-                g_hash_table_insert(self->favourites, g_strdup(favs[i]), GUINT_TO_POINTER(i));
+        old_order = self->favourites_order;
+        old = self->favourites;
+        self->favourites_order = g_ptr_array_new();
+        self->favourites = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+        for (guint i = 0; favs && favs[i]; i++) {
+                const gchar *fav = g_intern_string(favs[i]);
+
+                /* Skip blanks and dupes from hand edited settings */
+                if (g_str_equal(fav, "") || g_hash_table_contains(self->favourites, fav)) {
+                        continue;
+                }
+                g_hash_table_insert(self->favourites,
+                                    (gpointer)fav,
+                                    GUINT_TO_POINTER(self->favourites_order->len));
+                g_ptr_array_add(self->favourites_order, (gpointer)fav);
+        }
+
+        /* First load */
+        if (!old) {
+                return;
+        }
+
+        /* Added or moved */
+        for (guint i = 0; i < self->favourites_order->len; i++) {
+                id = g_ptr_array_index(self->favourites_order, i);
+                if (!g_hash_table_lookup_extended(old, id, NULL, &val) ||
+                    GPOINTER_TO_UINT(val) != i) {
+                        brisk_favourites_backend_notify(self, id);
+                }
+        }
+
+        /* Removed */
+        g_hash_table_iter_init(&iter, old);
+        while (g_hash_table_iter_next(&iter, &id, NULL)) {
+                if (!g_hash_table_contains(self->favourites, id)) {
+                        brisk_favourites_backend_notify(self, id);
+                }
         }
 }
 
@@ -150,27 +385,17 @@ static void brisk_favourites_backend_changed(GSettings *settings, const gchar *k
 static void brisk_favourites_backend_init(BriskFavouritesBackend *self)
 {
         self->settings = g_settings_new("com.solus-project.brisk-menu");
+
+        /* Writes are batched up and applied together */
+        g_settings_delay(self->settings);
+
         g_signal_connect(self->settings,
                          "changed::favourites",
                          G_CALLBACK(brisk_favourites_backend_changed),
                          self);
 
-        self->action_add = g_simple_action_new("favourites.pin", NULL);
-        g_signal_connect(self->action_add,
-                         "activate",
-                         G_CALLBACK(brisk_favourites_backend_pin_item),
-                         self);
-        self->action_remove = g_simple_action_new("favourites.unpin", NULL);
-        g_signal_connect(self->action_remove,
-                         "activate",
-                         G_CALLBACK(brisk_favourites_backend_unpin_item),
-                         self);
-
         brisk_favourites_backend_init_desktop(self);
 
-        /* Allow O(1) lookup for the "is pinned" logic */
-        self->favourites = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
-
         /* Force load of the backend pinned items */
         brisk_favourites_backend_changed(self->settings, "favourites", self);
 }
@@ -202,68 +427,30 @@ static gboolean brisk_favourites_backend_load(BriskBackend *backend)
         return TRUE;
 }
 
-static void brisk_favourites_backend_pin_item(__brisk_unused__ GSimpleAction *action,
+static void brisk_favourites_backend_pin_item(GSimpleAction *action,
                                               __brisk_unused__ GVariant *parameter,
                                               BriskFavouritesBackend *self)
 {
-        autofree(gstrv) *old = NULL;
-        autofree(GArray) *array = NULL;
-
-        if (!self->active_item) {
-                return;
-        }
+        BriskItem *item = g_object_get_data(G_OBJECT(action), "__item");
 
-        const gchar *item_id = brisk_item_get_id(self->active_item);
-        self->active_item = NULL;
-
-        /* prevent duping.. */
-        if (g_hash_table_contains(self->favourites, item_id)) {
+        if (!item) {
                 return;
         }
 
-        old = g_settings_get_strv(self->settings, "favourites");
-        array = g_array_new(TRUE, TRUE, sizeof(gchar *));
-
-        for (guint i = 0; i < g_strv_length(old); i++) {
-                if (!old[i] || g_str_equal(old[i], "")) {
-                        continue;
-                }
-                array = g_array_append_val(array, old[i]);
-        }
-
-        array = g_array_append_val(array, item_id);
-        g_settings_set_strv(self->settings, "favourites", (const gchar **)array->data);
+        brisk_favourites_backend_insert(self, brisk_item_get_id(item), -1);
 }
 
-static void brisk_favourites_backend_unpin_item(__brisk_unused__ GSimpleAction *action,
+static void brisk_favourites_backend_unpin_item(GSimpleAction *action,
                                                 __brisk_unused__ GVariant *parameter,
                                                 BriskFavouritesBackend *self)
 {
-        autofree(gstrv) *old = NULL;
-        autofree(GArray) *array = NULL;
+        BriskItem *item = g_object_get_data(G_OBJECT(action), "__item");
 
-        if (!self->active_item) {
+        if (!item) {
                 return;
         }
 
-        const gchar *item_id = brisk_item_get_id(self->active_item);
-        self->active_item = NULL;
-
-        old = g_settings_get_strv(self->settings, "favourites");
-        array = g_array_new(TRUE, TRUE, sizeof(gchar *));
-
-        for (guint i = 0; i < g_strv_length(old); i++) {
-                if (!old[i] || g_str_equal(old[i], "")) {
-                        continue;
-                }
-                if (!g_str_equal(old[i], item_id)) {
-                        array = g_array_append_val(array, old[i]);
-                }
-        }
-
-        g_settings_set_strv(self->settings, "favourites", (const gchar **)array->data);
-
-        brisk_backend_invalidate_filter(BRISK_BACKEND(self));
+        brisk_favourites_backend_remove(self, brisk_item_get_id(item));
 }
 
 /**
@@ -286,6 +473,17 @@ gint brisk_favourites_backend_get_item_order(BriskFavouritesBackend *self, Brisk
         return GPOINTER_TO_INT(val);
 }
 
+/**
+ * brisk_favourites_backend_get_pinned:
+ *
+ * Return the interned IDs of all pinned items, in pin order. The array is
+ * owned by the backend and only valid until the favourites next change.
+ */
+const GPtrArray *brisk_favourites_backend_get_pinned(BriskFavouritesBackend *self)
+{
+        return self->favourites_order;
+}
+
 /**
  * brisk_favourites_backend_new:
  *
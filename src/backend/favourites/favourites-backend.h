@@ -12,6 +12,7 @@
 #pragma once
 
 #include "../backend.h"
+#include <gio/gio.h>
 #include <glib-object.h>
 
 G_BEGIN_DECLS
@@ -29,14 +30,21 @@ struct _BriskFavouritesBackendClass {
 struct _BriskFavouritesBackend {
         BriskBackend parent;
         GSettings *settings;
+
+        /* Pinned IDs in order, and each ID's position for O(1) lookup */
+        GPtrArray *favourites_order;
         GHashTable *favourites;
+        guint apply_id;
+
+        /* Desktop pin/unpin operations, run in order off the main thread */
+        GQueue *desktop_ops;
+        GCancellable *desktop_cancellable;
+        gboolean desktop_busy;
 
-        /* Action management */
-        BriskItem *active_item;
-        GSimpleAction *action_remove;
-        GSimpleAction *action_add;
-        GSimpleAction *action_add_desktop;
-        GSimpleAction *action_remove_desktop;
+        /* Basenames of everything on the desktop, kept current by a monitor */
+        GFile *desktop_dir;
+        GFileMonitor *desktop_monitor;
+        GHashTable *desktop_files;
 };
 
 #define BRISK_TYPE_FAVOURITES_BACKEND brisk_favourites_backend_get_type()
@@ -57,9 +65,26 @@ BriskBackend *brisk_favourites_backend_new(void);
 
 gboolean brisk_favourites_backend_is_pinned(BriskFavouritesBackend *self, BriskItem *item);
 gint brisk_favourites_backend_get_item_order(BriskFavouritesBackend *self, BriskItem *item);
+const GPtrArray *brisk_favourites_backend_get_pinned(BriskFavouritesBackend *self);
+gboolean brisk_favourites_backend_insert(BriskFavouritesBackend *self, const gchar *id,
+                                         gint position);
+gboolean brisk_favourites_backend_remove(BriskFavouritesBackend *self, const gchar *id);
+gboolean brisk_favourites_backend_move(BriskFavouritesBackend *self, const gchar *id,
+                                       gint position);
 void brisk_favourites_backend_init_desktop(BriskFavouritesBackend *backend);
-void brisk_favourites_backend_menu_desktop(BriskFavouritesBackend *backend, GMenu *menu,
-                                           GActionGroup *group);
+void brisk_favourites_backend_dispose_desktop(BriskFavouritesBackend *backend);
+void brisk_favourites_backend_menu_desktop(BriskFavouritesBackend *backend, BriskItem *item,
+                                           GMenu *menu, GActionGroup *group);
+GSimpleAction *brisk_favourites_backend_item_action(BriskFavouritesBackend *backend,
+                                                    BriskItem *item, const gchar *name,
+                                                    GCallback callback);
+void brisk_favourites_backend_set_desktop_pinned_async(BriskFavouritesBackend *backend,
+                                                       BriskItem *item, gboolean pinned,
+                                                       GCancellable *cancellable,
+                                                       GAsyncReadyCallback callback,
+                                                       gpointer user_data);
+gboolean brisk_favourites_backend_set_desktop_pinned_finish(BriskFavouritesBackend *backend,
+                                                            GAsyncResult *result, GError **error);
 
 G_END_DECLS
 
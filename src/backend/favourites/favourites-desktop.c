@@ -15,16 +15,15 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "favourites-backend.h"
+#include "trace.h"
+#include <gio/gio.h>
 #include <glib/gi18n.h>
-#include <glib/gstdio.h>
 BRISK_END_PEDANTIC
 
-#include <errno.h>
-#include <string.h>
-
 DEF_AUTOFREE(GFile, g_object_unref)
 DEF_AUTOFREE(gchar, g_free)
 DEF_AUTOFREE(GError, g_error_free)
+DEF_AUTOFREE(GSimpleAction, g_object_unref)
 
 typedef enum {
         PIN_STATUS_UNPINNABLE = 0,
@@ -53,117 +52,442 @@ static GFile *get_desktop_item_source(BriskItem *item)
 }
 
 /**
- * get_item_path will return the path that would be pinned on the desktop
+ * get_desktop_item_target:
+ *
+ * Get the target GFile on the desktop. This never touches the disk, so
+ * it's safe to use from the UI thread.
  */
-static gchar *get_desktop_item_target_path(GFile *file)
+static GFile *get_desktop_item_target(GFile *file)
 {
-        if (!g_file_query_exists(file, NULL)) {
+        autofree(gchar) *basename = NULL;
+        autofree(gchar) *path = NULL;
+
+        basename = g_file_get_basename(file);
+        if (!basename) {
                 return NULL;
         }
-        autofree(gchar) *basename = g_file_get_basename(file);
 
-        return g_build_path(G_DIR_SEPARATOR_S,
+        path = g_build_path(G_DIR_SEPARATOR_S,
                             g_get_user_special_dir(G_USER_DIRECTORY_DESKTOP),
                             basename,
                             NULL);
+        return g_file_new_for_path(path);
 }
 
 /**
- * get_desktop_item_target:
- *
- * Get the target GFile on the desktop
+ * Record whether a file of that name is currently on the desktop
  */
-static GFile *get_desktop_item_target(GFile *file)
+static void brisk_favourites_backend_desktop_track(BriskFavouritesBackend *self,
+                                                   const gchar *basename, gboolean present)
 {
-        autofree(gchar) *path = NULL;
+        gboolean changed = FALSE;
 
-        path = get_desktop_item_target_path(file);
-        return g_file_new_for_path(path);
+        /* A pin may finish after dispose has torn the table down */
+        if (!basename || !self->desktop_files) {
+                return;
+        }
+        if (present) {
+                changed = !g_hash_table_contains(self->desktop_files, basename);
+                g_hash_table_add(self->desktop_files, g_strdup(basename));
+        } else {
+                changed = g_hash_table_remove(self->desktop_files, basename);
+        }
+
+        /* Item IDs needn't match the basename, so cached menus all go */
+        if (changed && g_str_has_suffix(basename, ".desktop")) {
+                brisk_backend_actions_changed(BRISK_BACKEND(self), NULL);
+        }
 }
 
 /**
- * brisk_favourites_backend_action_desktop_pin will pin the item to the desktop
- * by copying the source file to the target
+ * Keep our view of the desktop in sync with what lands on or leaves it
  */
-static void brisk_favourites_backend_action_desktop_pin(__brisk_unused__ GSimpleAction *action,
-                                                        __brisk_unused__ GVariant *parameter,
-                                                        BriskFavouritesBackend *self)
+static void brisk_favourites_backend_desktop_changed(__brisk_unused__ GFileMonitor *monitor,
+                                                     GFile *file, GFile *other_file,
+                                                     GFileMonitorEvent event,
+                                                     BriskFavouritesBackend *self)
 {
-        autofree(GFile) *source = NULL;
-        autofree(GFile) *dest = NULL;
+        autofree(gchar) *basename = g_file_get_basename(file);
+
+        switch (event) {
+        case G_FILE_MONITOR_EVENT_CREATED:
+                brisk_favourites_backend_desktop_track(self, basename, TRUE);
+                break;
+        case G_FILE_MONITOR_EVENT_DELETED:
+                brisk_favourites_backend_desktop_track(self, basename, FALSE);
+                break;
+        case G_FILE_MONITOR_EVENT_MOVED:
+                brisk_favourites_backend_desktop_track(self, basename, FALSE);
+                if (other_file && g_file_has_parent(other_file, self->desktop_dir)) {
+                        autofree(gchar) *other = g_file_get_basename(other_file);
+                        brisk_favourites_backend_desktop_track(self, other, TRUE);
+                }
+                break;
+        default:
+                break;
+        }
+}
+
+static void brisk_favourites_backend_desktop_next_files(GObject *source_object,
+                                                        GAsyncResult *result, gpointer v)
+{
+        GFileEnumerator *enumerator = G_FILE_ENUMERATOR(source_object);
+        BriskFavouritesBackend *self = v;
         autofree(GError) *error = NULL;
-        autofree(gchar) *path = NULL;
+        GList *infos = NULL;
 
-        source = get_desktop_item_source(self->active_item);
-        if (!source) {
+        infos = g_file_enumerator_next_files_finish(enumerator, result, &error);
+        if (error) {
+                if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+                        g_message("Unable to list desktop: %s", error->message);
+                }
+                g_object_unref(enumerator);
                 return;
         }
-        dest = get_desktop_item_target(source);
-        if (!dest) {
+
+        /* All done */
+        if (!infos) {
+                g_file_enumerator_close_async(enumerator, G_PRIORITY_LOW, NULL, NULL, NULL);
+                g_object_unref(enumerator);
                 return;
         }
 
-        path = g_file_get_path(dest);
-        if (!path) {
+        for (GList *elem = infos; elem; elem = elem->next) {
+                brisk_favourites_backend_desktop_track(self,
+                                                       g_file_info_get_name(elem->data),
+                                                       TRUE);
+        }
+        g_list_free_full(infos, g_object_unref);
+
+        g_file_enumerator_next_files_async(enumerator,
+                                           64,
+                                           G_PRIORITY_LOW,
+                                           self->desktop_cancellable,
+                                           brisk_favourites_backend_desktop_next_files,
+                                           self);
+}
+
+static void brisk_favourites_backend_desktop_enumerated(GObject *source_object,
+                                                        GAsyncResult *result, gpointer v)
+{
+        BriskFavouritesBackend *self = v;
+        autofree(GError) *error = NULL;
+        GFileEnumerator *enumerator = NULL;
+
+        enumerator = g_file_enumerate_children_finish(G_FILE(source_object), result, &error);
+        if (error) {
+                if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) &&
+                    !g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)) {
+                        g_message("Unable to list desktop: %s", error->message);
+                }
                 return;
         }
 
-        /* Consider making async. */
-        if (!g_file_copy(source,
-                         dest,
+        g_file_enumerator_next_files_async(enumerator,
+                                           64,
+                                           G_PRIORITY_LOW,
+                                           self->desktop_cancellable,
+                                           brisk_favourites_backend_desktop_next_files,
+                                           self);
+}
+
+/**
+ * Fill the desktop set in the background, and have the monitor keep it up
+ * to date from then on. Pin status is then a lookup that never needs to
+ * touch the filesystem, which matters on network homes.
+ */
+static void brisk_favourites_backend_watch_desktop(BriskFavouritesBackend *self)
+{
+        autofree(GError) *error = NULL;
+
+        self->desktop_files = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+        self->desktop_dir = g_file_new_for_path(g_get_user_special_dir(G_USER_DIRECTORY_DESKTOP));
+
+        self->desktop_monitor =
+            g_file_monitor_directory(self->desktop_dir, G_FILE_MONITOR_SEND_MOVED, NULL, &error);
+        if (error) {
+                g_message("Unable to monitor desktop: %s", error->message);
+        } else {
+                g_signal_connect(self->desktop_monitor,
+                                 "changed",
+                                 G_CALLBACK(brisk_favourites_backend_desktop_changed),
+                                 self);
+        }
+
+        g_file_enumerate_children_async(self->desktop_dir,
+                                        G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                        G_FILE_QUERY_INFO_NONE,
+                                        G_PRIORITY_LOW,
+                                        self->desktop_cancellable,
+                                        brisk_favourites_backend_desktop_enumerated,
+                                        self);
+}
+
+/**
+ * A single queued pin or unpin
+ */
+typedef struct DesktopOp {
+        gboolean pin;  /**<Copy to the desktop, otherwise remove from it */
+        GFile *source; /**<The item's .desktop file */
+        GFile *dest;   /**<Where it lives on the desktop */
+        GTask *outer;  /**<Reported back to the caller on completion */
+} DesktopOp;
+
+static void desktop_op_free(DesktopOp *op)
+{
+        g_clear_object(&op->source);
+        g_clear_object(&op->dest);
+        g_clear_object(&op->outer);
+        g_free(op);
+}
+
+/**
+ * Copy the source file over to the desktop
+ */
+static gboolean desktop_op_pin(DesktopOp *op, GCancellable *cancellable, GError **error)
+{
+        autofree(GError) *chmod_error = NULL;
+
+        if (!g_file_copy(op->source,
+                         op->dest,
                          G_FILE_COPY_ALL_METADATA | G_FILE_COPY_OVERWRITE,
+                         cancellable,
                          NULL,
                          NULL,
-                         NULL,
-                         &error)) {
-                /* Consider using libnotify */
-                g_message("Failed to pin desktop item: %s", error->message);
+                         error)) {
+                return FALSE;
         }
 
         /* MATE will sanitize .desktop files that are chmod +x */
-        int r = g_chmod(path, 00755);
-        if (r != 0) {
-                g_message("Failed to chmod desktop item: %s", strerror(errno));
+        if (!g_file_set_attribute_uint32(op->dest,
+                                         G_FILE_ATTRIBUTE_UNIX_MODE,
+                                         00755,
+                                         G_FILE_QUERY_INFO_NONE,
+                                         cancellable,
+                                         &chmod_error)) {
+                g_message("Failed to chmod desktop item: %s", chmod_error->message);
         }
+        return TRUE;
 }
 
 /**
- * brisk_favourites_backend_action_desktop_unpin will attempt to unpin the item
- * from the desktop by removing the .desktop file
+ * Remove the file from the desktop, where it already being gone is fine
  */
-static void brisk_favourites_backend_action_desktop_unpin(__brisk_unused__ GSimpleAction *action,
-                                                          __brisk_unused__ GVariant *parameter,
-                                                          BriskFavouritesBackend *self)
+static gboolean desktop_op_unpin(DesktopOp *op, GCancellable *cancellable, GError **error)
+{
+        autofree(GError) *delete_error = NULL;
+
+        if (g_file_delete(op->dest, cancellable, &delete_error)) {
+                return TRUE;
+        }
+        if (g_error_matches(delete_error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)) {
+                return TRUE;
+        }
+        g_propagate_error(error, delete_error);
+        delete_error = NULL;
+        return FALSE;
+}
+
+/**
+ * Runs in a worker thread, so may block on the disk as long as it likes
+ */
+static void desktop_op_thread(GTask *task, __brisk_unused__ gpointer source_object,
+                              gpointer task_data, GCancellable *cancellable)
+{
+        DesktopOp *op = task_data;
+        GError *error = NULL;
+        gboolean ret = FALSE;
+
+        if (g_task_return_error_if_cancelled(task)) {
+                return;
+        }
+
+        /* The caller can only call off an operation that hasn't started yet */
+        if (g_cancellable_set_error_if_cancelled(g_task_get_cancellable(op->outer), &error)) {
+                g_task_return_error(task, error);
+                return;
+        }
+
+        ret = op->pin ? desktop_op_pin(op, cancellable, &error)
+                      : desktop_op_unpin(op, cancellable, &error);
+        if (!ret) {
+                g_task_return_error(task, error);
+                return;
+        }
+        g_task_return_boolean(task, TRUE);
+}
+
+static void brisk_favourites_backend_desktop_next(BriskFavouritesBackend *self);
+
+/**
+ * Back on the main thread: tell the caller, then move onto the next one
+ */
+static void desktop_op_done(GObject *source_object, GAsyncResult *result,
+                            __brisk_unused__ gpointer v)
+{
+        BriskFavouritesBackend *self = BRISK_FAVOURITES_BACKEND(source_object);
+        DesktopOp *op = g_task_get_task_data(G_TASK(result));
+        GError *error = NULL;
+
+        if (g_task_propagate_boolean(G_TASK(result), &error)) {
+                /* Don't wait on the monitor, the next popup should be right */
+                autofree(gchar) *basename = g_file_get_basename(op->dest);
+                brisk_favourites_backend_desktop_track(self, basename, op->pin);
+                g_task_return_boolean(op->outer, TRUE);
+        } else {
+                g_task_return_error(op->outer, error);
+        }
+
+        self->desktop_busy = FALSE;
+        brisk_favourites_backend_desktop_next(self);
+}
+
+/**
+ * Operations run strictly one at a time and in order, so that a pin
+ * followed by an unpin of the same item can't race each other
+ */
+static void brisk_favourites_backend_desktop_next(BriskFavouritesBackend *self)
+{
+        GTask *task = NULL;
+
+        if (self->desktop_busy || !self->desktop_ops) {
+                return;
+        }
+
+        task = g_queue_pop_head(self->desktop_ops);
+        if (!task) {
+                return;
+        }
+
+        self->desktop_busy = TRUE;
+        g_task_run_in_thread(task, desktop_op_thread);
+        g_object_unref(task);
+}
+
+/**
+ * brisk_favourites_backend_set_desktop_pinned_async:
+ *
+ * Queue pinning (copying) the item's .desktop file to the desktop, or
+ * unpinning (removing) it. The disk is only touched from a worker thread,
+ * with @callback invoked on the main thread once the operation completes.
+ */
+void brisk_favourites_backend_set_desktop_pinned_async(BriskFavouritesBackend *self,
+                                                       BriskItem *item, gboolean pinned,
+                                                       GCancellable *cancellable,
+                                                       GAsyncReadyCallback callback,
+                                                       gpointer user_data)
 {
+        DesktopOp *op = NULL;
+        GTask *outer = NULL;
+        GTask *task = NULL;
         autofree(GFile) *source = NULL;
-        autofree(GFile) *dest = NULL;
-        autofree(GError) *error = NULL;
 
-        source = get_desktop_item_source(self->active_item);
+        outer = g_task_new(self, cancellable, callback, user_data);
+        g_task_set_source_tag(outer, brisk_favourites_backend_set_desktop_pinned_async);
+
+        source = get_desktop_item_source(item);
         if (!source) {
+                g_task_return_new_error(outer,
+                                        G_IO_ERROR,
+                                        G_IO_ERROR_NOT_SUPPORTED,
+                                        "Item has no desktop file");
+                g_object_unref(outer);
                 return;
         }
 
-        dest = get_desktop_item_target(source);
-        if (!dest || !g_file_query_exists(dest, NULL)) {
+        op = g_new0(DesktopOp, 1);
+        op->pin = pinned;
+        op->source = g_object_ref(source);
+        op->dest = get_desktop_item_target(source);
+        op->outer = outer;
+
+        /* Runs against our own cancellable so dispose can stop it part way */
+        task = g_task_new(self, self->desktop_cancellable, desktop_op_done, NULL);
+        g_task_set_task_data(task, op, (GDestroyNotify)desktop_op_free);
+        g_queue_push_tail(self->desktop_ops, task);
+
+        brisk_favourites_backend_desktop_next(self);
+}
+
+/**
+ * brisk_favourites_backend_set_desktop_pinned_finish:
+ *
+ * Complete a pin or unpin, returning FALSE and setting @error on failure
+ */
+gboolean brisk_favourites_backend_set_desktop_pinned_finish(BriskFavouritesBackend *self,
+                                                            GAsyncResult *result, GError **error)
+{
+        g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+        return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+static void brisk_favourites_backend_desktop_pin_cb(GObject *source_object, GAsyncResult *result,
+                                                    __brisk_unused__ gpointer v)
+{
+        BriskFavouritesBackend *self = BRISK_FAVOURITES_BACKEND(source_object);
+        autofree(GError) *error = NULL;
+
+        if (brisk_favourites_backend_set_desktop_pinned_finish(self, result, &error)) {
                 return;
         }
-
-        if (!g_file_delete(dest, NULL, &error)) {
-                /* Consider using libnotify */
-                g_message("Unable to unpin desktop item: %s", error->message);
+        if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+                return;
         }
+        /* Consider using libnotify */
+        g_message("Failed to update desktop item: %s", error->message);
+}
+
+/**
+ * brisk_favourites_backend_action_desktop_pin will pin the item to the desktop
+ * by copying the source file to the target
+ */
+static void brisk_favourites_backend_action_desktop_pin(GSimpleAction *action,
+                                                        __brisk_unused__ GVariant *parameter,
+                                                        BriskFavouritesBackend *self)
+{
+        BriskItem *item = g_object_get_data(G_OBJECT(action), "__item");
+
+        brisk_trace_span("favourites.desktop-pin");
+
+        brisk_favourites_backend_set_desktop_pinned_async(self,
+                                                          item,
+                                                          TRUE,
+                                                          self->desktop_cancellable,
+                                                          brisk_favourites_backend_desktop_pin_cb,
+                                                          NULL);
+}
+
+/**
+ * brisk_favourites_backend_action_desktop_unpin will attempt to unpin the item
+ * from the desktop by removing the .desktop file
+ */
+static void brisk_favourites_backend_action_desktop_unpin(GSimpleAction *action,
+                                                          __brisk_unused__ GVariant *parameter,
+                                                          BriskFavouritesBackend *self)
+{
+        BriskItem *item = g_object_get_data(G_OBJECT(action), "__item");
+
+        brisk_trace_span("favourites.desktop-unpin");
+
+        brisk_favourites_backend_set_desktop_pinned_async(self,
+                                                          item,
+                                                          FALSE,
+                                                          self->desktop_cancellable,
+                                                          brisk_favourites_backend_desktop_pin_cb,
+                                                          NULL);
 }
 
 /**
- * brisk_favourites_backend_is_desktop_pinned:
+ * brisk_favourites_backend_get_desktop_pin_status:
  *
- * Determine if the source file is actually pinned to the desktop or not
+ * Determine if the source file is actually pinned to the desktop or not,
+ * purely from our in-memory view of the desktop
  */
-static DesktopPinStatus brisk_favourites_backend_get_desktop_pin_status(BriskItem *item)
+static DesktopPinStatus brisk_favourites_backend_get_desktop_pin_status(
+    BriskFavouritesBackend *self, BriskItem *item)
 {
         autofree(GFile) *source = NULL;
-        autofree(GFile) *dest = NULL;
         autofree(gchar) *base = NULL;
 
         source = get_desktop_item_source(item);
@@ -173,12 +497,11 @@ static DesktopPinStatus brisk_favourites_backend_get_desktop_pin_status(BriskIte
 
         /* .desktop .. */
         base = g_file_get_basename(source);
-        if (!g_str_has_suffix(base, ".desktop")) {
+        if (!base || !g_str_has_suffix(base, ".desktop")) {
                 return PIN_STATUS_UNPINNABLE;
         }
 
-        dest = get_desktop_item_target(source);
-        if (!dest || !g_file_query_exists(dest, NULL)) {
+        if (!g_hash_table_contains(self->desktop_files, base)) {
                 return PIN_STATUS_UNPINNED;
         }
 
@@ -192,16 +515,45 @@ static DesktopPinStatus brisk_favourites_backend_get_desktop_pin_status(BriskIte
  */
 void brisk_favourites_backend_init_desktop(BriskFavouritesBackend *self)
 {
-        self->action_add_desktop = g_simple_action_new("favourites.pin-desktop", NULL);
-        g_signal_connect(self->action_add_desktop,
-                         "activate",
-                         G_CALLBACK(brisk_favourites_backend_action_desktop_pin),
-                         self);
-        self->action_remove_desktop = g_simple_action_new("favourites.unpin-desktop", NULL);
-        g_signal_connect(self->action_remove_desktop,
-                         "activate",
-                         G_CALLBACK(brisk_favourites_backend_action_desktop_unpin),
-                         self);
+        self->desktop_ops = g_queue_new();
+        self->desktop_cancellable = g_cancellable_new();
+        brisk_favourites_backend_watch_desktop(self);
+}
+
+/**
+ * brisk_favourites_backend_dispose_desktop:
+ *
+ * Abandon anything still queued, so each caller hears back with
+ * G_IO_ERROR_CANCELLED, and cancel the operation currently running.
+ */
+void brisk_favourites_backend_dispose_desktop(BriskFavouritesBackend *self)
+{
+        GQueue *ops = self->desktop_ops;
+        GTask *task = NULL;
+
+        /* Nothing new may start from here on, desktop_op_done included */
+        self->desktop_ops = NULL;
+        if (ops) {
+                while ((task = g_queue_pop_head(ops)) != NULL) {
+                        g_task_return_new_error(task,
+                                                G_IO_ERROR,
+                                                G_IO_ERROR_CANCELLED,
+                                                "Favourites backend was disposed");
+                        g_object_unref(task);
+                }
+                g_queue_free(ops);
+        }
+
+        if (self->desktop_cancellable) {
+                g_cancellable_cancel(self->desktop_cancellable);
+                g_clear_object(&self->desktop_cancellable);
+        }
+        if (self->desktop_monitor) {
+                g_file_monitor_cancel(self->desktop_monitor);
+                g_clear_object(&self->desktop_monitor);
+        }
+        g_clear_object(&self->desktop_dir);
+        g_clear_pointer(&self->desktop_files, g_hash_table_unref);
 }
 
 /**
@@ -209,20 +561,29 @@ void brisk_favourites_backend_init_desktop(BriskFavouritesBackend *self)
  *
  * Add relevant entries to the context menu pertaining to .desktop handling
  */
-void brisk_favourites_backend_menu_desktop(BriskFavouritesBackend *self, GMenu *menu,
-                                           GActionGroup *group)
+void brisk_favourites_backend_menu_desktop(BriskFavouritesBackend *self, BriskItem *item,
+                                           GMenu *menu, GActionGroup *group)
 {
-        g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(self->action_add_desktop));
-        g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(self->action_remove_desktop));
-        DesktopPinStatus t = brisk_favourites_backend_get_desktop_pin_status(self->active_item);
+        autofree(GSimpleAction) *action = NULL;
+        DesktopPinStatus t = brisk_favourites_backend_get_desktop_pin_status(self, item);
 
         switch (t) {
         case PIN_STATUS_PINNED:
+                action = brisk_favourites_backend_item_action(
+                    self,
+                    item,
+                    "favourites.unpin-desktop",
+                    G_CALLBACK(brisk_favourites_backend_action_desktop_unpin));
                 g_menu_append(menu,
                               _("Unpin from desktop"),
                               "brisk-context-items.favourites.unpin-desktop");
                 break;
         case PIN_STATUS_UNPINNED:
+                action = brisk_favourites_backend_item_action(
+                    self,
+                    item,
+                    "favourites.pin-desktop",
+                    G_CALLBACK(brisk_favourites_backend_action_desktop_pin));
                 g_menu_append(menu,
                               _("Pin to desktop"),
                               "brisk-context-items.favourites.pin-desktop");
@@ -231,6 +592,8 @@ void brisk_favourites_backend_menu_desktop(BriskFavouritesBackend *self, GMenu *
         default:
                 return;
         }
+
+        g_action_map_add_action(G_ACTION_MAP(group), G_ACTION(action));
 }
 
 /*
@@ -76,6 +76,8 @@ static const gchar *brisk_favourites_section_get_name(BriskSection *section);
 static const GIcon *brisk_favourites_section_get_icon(BriskSection *section);
 static const gchar *brisk_favourites_section_get_backend_id(BriskSection *section);
 static gint brisk_favourites_section_get_sort_order(BriskSection *section, BriskItem *item);
+static gboolean brisk_favourites_section_set_sort_order(BriskSection *section, BriskItem *item,
+                                                       gint order);
 static gboolean brisk_favourites_section_can_show_item(BriskSection *section, BriskItem *item);
 
 /**
@@ -109,6 +111,7 @@ static void brisk_favourites_section_class_init(BriskFavouritesSectionClass *kla
         s_class->get_backend_id = brisk_favourites_section_get_backend_id;
         s_class->can_show_item = brisk_favourites_section_can_show_item;
         s_class->get_sort_order = brisk_favourites_section_get_sort_order;
+        s_class->set_sort_order = brisk_favourites_section_set_sort_order;
 
         obj_class->dispose = brisk_favourites_section_dispose;
         obj_class->set_property = brisk_favourites_section_set_property;
@@ -140,7 +143,7 @@ static gboolean brisk_favourites_section_get_item_is_pinned(BriskSection *sectio
 
 static const gchar *brisk_favourites_section_get_id(__brisk_unused__ BriskSection *section)
 {
-        return "favourites";
+        return g_intern_static_string("favourites");
 }
 
 static const gchar *brisk_favourites_section_get_name(__brisk_unused__ BriskSection *section)
@@ -156,7 +159,7 @@ static const GIcon *brisk_favourites_section_get_icon(BriskSection *section)
 
 static const gchar *brisk_favourites_section_get_backend_id(__brisk_unused__ BriskSection *item)
 {
-        return "favourites";
+        return g_intern_static_string("favourites");
 }
 
 static gboolean brisk_favourites_section_can_show_item(__brisk_unused__ BriskSection *section,
@@ -172,6 +175,14 @@ static gint brisk_favourites_section_get_sort_order(BriskSection *section, Brisk
         return brisk_favourites_backend_get_item_order(self->backend, item);
 }
 
+static gboolean brisk_favourites_section_set_sort_order(BriskSection *section, BriskItem *item,
+                                                       gint order)
+{
+        BriskFavouritesSection *self = BRISK_FAVOURITES_SECTION(section);
+
+        return brisk_favourites_backend_move(self->backend, brisk_item_get_id(item), order);
+}
+
 /**
  * brisk_favourites_section_new:
  *
@@ -15,10 +15,13 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "item.h"
+#include <string.h>
 BRISK_END_PEDANTIC
 
 G_DEFINE_TYPE(BriskItem, brisk_item, G_TYPE_INITIALLY_UNOWNED)
 
+static gsize brisk_item_real_get_memory_size(BriskItem *item);
+
 /**
  * brisk_item_dispose:
  *
@@ -40,6 +43,8 @@ static void brisk_item_class_init(BriskItemClass *klazz)
 
         /* gobject vtable hookup */
         obj_class->dispose = brisk_item_dispose;
+
+        klazz->get_memory_size = brisk_item_real_get_memory_size;
 }
 
 /**
@@ -55,7 +60,7 @@ static void brisk_item_init(__brisk_unused__ BriskItem *self)
  * brisk_item_get_id:
  *
  * Returns the unique ID for this item within the backend
- * @note This string belongs to the backend, and must not be freed by the caller
+ * @note This string is interned, and may be compared by pointer
  */
 const gchar *brisk_item_get_id(BriskItem *item)
 {
@@ -126,6 +131,7 @@ const GIcon *brisk_item_get_icon(BriskItem *item)
  * brisk_item_get_backend_id:
  *
  * Return the ID of the owning backend
+ * @note This string is interned, and may be compared by pointer
  */
 const gchar *brisk_item_get_backend_id(BriskItem *item)
 {
@@ -176,6 +182,78 @@ gchar *brisk_item_get_uri(BriskItem *item)
         return klazz->get_uri(item);
 }
 
+static inline gsize brisk_item_string_size(const gchar *str)
+{
+        return str ? strlen(str) + 1 : 0;
+}
+
+/**
+ * Default accounting covers the instance and the strings it exposes. The ID
+ * and backend ID are interned, so they're shared and not counted here.
+ */
+static gsize brisk_item_real_get_memory_size(BriskItem *item)
+{
+        GTypeQuery query = { 0 };
+        const gchar *name = brisk_item_get_name(item);
+        const gchar *display_name = brisk_item_get_display_name(item);
+        gsize size = 0;
+
+        g_type_query(G_OBJECT_TYPE(item), &query);
+
+        size = query.instance_size + brisk_item_string_size(name);
+        if (display_name != name) {
+                size += brisk_item_string_size(display_name);
+        }
+        return size + brisk_item_string_size(brisk_item_get_summary(item));
+}
+
+/**
+ * brisk_item_get_memory_size:
+ *
+ * Approximate number of bytes held by this item, used for diagnostics only
+ */
+gsize brisk_item_get_memory_size(BriskItem *item)
+{
+        g_assert(item != NULL);
+        BriskItemClass *klazz = BRISK_ITEM_GET_CLASS(item);
+        g_assert(klazz->get_memory_size != NULL);
+        return klazz->get_memory_size(item);
+}
+
+/**
+ * brisk_item_get_parent:
+ *
+ * Return the item this one is a sub-item of, such as the application a
+ * desktop action belongs to, or NULL for top level items
+ * @note The returned item is owned by this item
+ */
+BriskItem *brisk_item_get_parent(BriskItem *item)
+{
+        g_assert(item != NULL);
+        BriskItemClass *klazz = BRISK_ITEM_GET_CLASS(item);
+        if (!klazz->get_parent) {
+                return NULL;
+        }
+        return klazz->get_parent(item);
+}
+
+/**
+ * brisk_item_get_executable:
+ *
+ * Return the program this item runs when launched, which may be a bare
+ * name still to be looked up in PATH, or NULL if there isn't one
+ * @note The returned string is owned by this item
+ */
+const gchar *brisk_item_get_executable(BriskItem *item)
+{
+        g_assert(item != NULL);
+        BriskItemClass *klazz = BRISK_ITEM_GET_CLASS(item);
+        if (!klazz->get_executable) {
+                return NULL;
+        }
+        return klazz->get_executable(item);
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -22,7 +22,9 @@ typedef struct _BriskItemClass BriskItemClass;
 struct _BriskItemClass {
         GInitiallyUnownedClass parent_class;
 
-        /* These must be implemented by subclasses */
+        /* These must be implemented by subclasses. The IDs returned by get_id
+         * and get_backend_id must be interned strings (see g_intern_string) so
+         * that the frontend can hash and compare them by pointer */
         const gchar *(*get_id)(BriskItem *);
         const gchar *(*get_display_name)(BriskItem *);
         const gchar *(*get_name)(BriskItem *);
@@ -39,7 +41,18 @@ struct _BriskItemClass {
         /* For drag & drop */
         gchar *(*get_uri)(BriskItem *);
 
-        gpointer padding[12];
+        /* Memory accounting, subclasses should chain up and add anything
+         * they hold beyond their strings */
+        gsize (*get_memory_size)(BriskItem *);
+
+        /* Sub-items, such as desktop actions, return the item they belong to */
+        BriskItem *(*get_parent)(BriskItem *);
+
+        /* Program this item will execute when launched, if known. Must not
+         * touch the disk */
+        const gchar *(*get_executable)(BriskItem *);
+
+        gpointer padding[9];
 };
 
 /**
@@ -75,6 +88,15 @@ gboolean brisk_item_launch(BriskItem *item, GAppLaunchContext *context);
 
 gchar *brisk_item_get_uri(BriskItem *item);
 
+/* Approximate bytes held by this item */
+gsize brisk_item_get_memory_size(BriskItem *item);
+
+/* Owning item for sub-items, otherwise NULL */
+BriskItem *brisk_item_get_parent(BriskItem *item);
+
+/* Program run on launch, if known */
+const gchar *brisk_item_get_executable(BriskItem *item);
+
 G_END_DECLS
 
 /*
@@ -15,10 +15,13 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "section.h"
+#include <string.h>
 BRISK_END_PEDANTIC
 
 G_DEFINE_TYPE(BriskSection, brisk_section, G_TYPE_INITIALLY_UNOWNED)
 
+static gsize brisk_section_real_get_memory_size(BriskSection *section);
+
 /**
  * brisk_section_dispose:
  *
@@ -40,6 +43,8 @@ static void brisk_section_class_init(BriskSectionClass *klazz)
 
         /* gobject vtable hookup */
         obj_class->dispose = brisk_section_dispose;
+
+        klazz->get_memory_size = brisk_section_real_get_memory_size;
 }
 
 /**
@@ -55,7 +60,7 @@ static void brisk_section_init(__brisk_unused__ BriskSection *self)
  * brisk_section_get_id:
  *
  * Returns the unique ID for this section within the backend
- * @note This string belongs to the section, and must not be freed by the caller
+ * @note This string is interned, and may be compared by pointer
  */
 const gchar *brisk_section_get_id(BriskSection *section)
 {
@@ -98,6 +103,7 @@ const GIcon *brisk_section_get_icon(BriskSection *section)
  * brisk_section_get_backend_id:
  *
  * Return the ID for the backend that owns this section
+ * @note This string is interned, and may be compared by pointer
  */
 const gchar *brisk_section_get_backend_id(BriskSection *section)
 {
@@ -145,6 +151,48 @@ gint brisk_section_get_sort_order(BriskSection *section, BriskItem *item)
         return klazz->get_sort_order(section, item);
 }
 
+/**
+ * brisk_section_set_sort_order:
+ *
+ * Move the item to the given position within the section's custom order,
+ * as returned by brisk_section_get_sort_order. Returns FALSE if the
+ * section doesn't support reordering, or nothing moved.
+ */
+gboolean brisk_section_set_sort_order(BriskSection *section, BriskItem *item, gint order)
+{
+        g_assert(section != NULL);
+        BriskSectionClass *klazz = BRISK_SECTION_GET_CLASS(section);
+        if (!klazz->set_sort_order) {
+                return FALSE;
+        }
+        return klazz->set_sort_order(section, item, order);
+}
+
+/**
+ * Default accounting covers the instance and its name, IDs are interned
+ */
+static gsize brisk_section_real_get_memory_size(BriskSection *section)
+{
+        GTypeQuery query = { 0 };
+        const gchar *name = brisk_section_get_name(section);
+
+        g_type_query(G_OBJECT_TYPE(section), &query);
+        return query.instance_size + (name ? strlen(name) + 1 : 0);
+}
+
+/**
+ * brisk_section_get_memory_size:
+ *
+ * Approximate number of bytes held by this section, used for diagnostics only
+ */
+gsize brisk_section_get_memory_size(BriskSection *section)
+{
+        g_assert(section != NULL);
+        BriskSectionClass *klazz = BRISK_SECTION_GET_CLASS(section);
+        g_assert(klazz->get_memory_size != NULL);
+        return klazz->get_memory_size(section);
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
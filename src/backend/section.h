@@ -23,7 +23,8 @@ typedef struct _BriskSectionClass BriskSectionClass;
 struct _BriskSectionClass {
         GInitiallyUnownedClass parent_class;
 
-        /* These must be implemented by subclasses */
+        /* These must be implemented by subclasses. The IDs returned by get_id
+         * and get_backend_id must be interned strings (see g_intern_string) */
         const gchar *(*get_id)(BriskSection *);
         const gchar *(*get_name)(BriskSection *);
         const GIcon *(*get_icon)(BriskSection *);
@@ -33,7 +34,13 @@ struct _BriskSectionClass {
 
         gint (*get_sort_order)(BriskSection *, BriskItem *);
 
-        gpointer padding[12];
+        /* Optional, for sections that let the user reorder their items */
+        gboolean (*set_sort_order)(BriskSection *, BriskItem *, gint);
+
+        /* Memory accounting, subclasses should chain up */
+        gsize (*get_memory_size)(BriskSection *);
+
+        gpointer padding[10];
 };
 
 /**
@@ -63,6 +70,8 @@ const GIcon *brisk_section_get_icon(BriskSection *section);
 const gchar *brisk_section_get_backend_id(BriskSection *section);
 gboolean brisk_section_can_show_item(BriskSection *section, BriskItem *item);
 gint brisk_section_get_sort_order(BriskSection *section, BriskItem *item);
+gboolean brisk_section_set_sort_order(BriskSection *section, BriskItem *item, gint order);
+gsize brisk_section_get_memory_size(BriskSection *section);
 
 G_END_DECLS
 
@@ -21,6 +21,7 @@ BRISK_BEGIN_PEDANTIC
 #include "classic-window.h"
 #include "desktop-button.h"
 #include "sidebar-scroller.h"
+#include "trace.h"
 
 #include <gio/gdesktopappinfo.h>
 #include <glib/gi18n.h>
@@ -36,9 +37,10 @@ static void brisk_classic_window_load_css(BriskClassicWindow *self);
 static void brisk_classic_window_key_activate(BriskClassicWindow *self, gpointer v);
 static void brisk_classic_window_activated(BriskMenuWindow *self, GtkListBoxRow *row, gpointer v);
 static void brisk_classic_window_setup_session_controls(BriskClassicWindow *self);
+static void brisk_classic_window_update_session(BriskMenuWindow *window);
 static void brisk_classic_window_build_sidebar(BriskMenuWindow *self);
 static void brisk_classic_window_add_shortcut(BriskMenuWindow *self, const gchar *id);
-static void brisk_classic_window_set_filters_enabled(BriskClassicWindow *self, gboolean enabled);
+static void brisk_classic_window_set_filters_enabled(BriskMenuWindow *window, gboolean enabled);
 static gboolean brisk_classic_window_filter_apps(GtkListBoxRow *row, gpointer v);
 static gint brisk_classic_window_sort(GtkListBoxRow *row1, GtkListBoxRow *row2, gpointer v);
 
@@ -200,10 +202,15 @@ static void brisk_classic_window_add_item(BriskMenuWindow *self, BriskItem *item
                                  "show-context-menu",
                                  G_CALLBACK(brisk_menu_window_show_context),
                                  self);
+        g_signal_connect_swapped(button,
+                                 "item-dropped",
+                                 G_CALLBACK(brisk_menu_window_item_dropped),
+                                 self);
+        brisk_menu_window_update_sort_order(self, BRISK_MENU_ENTRY_BUTTON(button));
         gtk_container_add(GTK_CONTAINER(BRISK_CLASSIC_WINDOW(self)->apps), button);
         gtk_widget_show_all(button);
 
-        g_hash_table_insert(self->item_store, g_strdup(item_id), button);
+        g_hash_table_insert(self->item_store, (gchar *)item_id, button);
 }
 
 /**
@@ -226,12 +233,12 @@ static void brisk_classic_window_add_section(BriskMenuWindow *self, BriskSection
         button = brisk_classic_category_button_new(section);
         gtk_radio_button_join_group(GTK_RADIO_BUTTON(button),
                                     GTK_RADIO_BUTTON(self->section_box_leader));
-        gtk_box_pack_start(GTK_BOX(box_target), button, FALSE, FALSE, 0);
+        brisk_menu_window_pack_section(box_target, button, section);
         brisk_classic_window_associate_category(self, button);
         gtk_widget_show_all(button);
 
         /* Avoid new dupes */
-        g_hash_table_insert(self->item_store, g_strdup(section_id), button);
+        g_hash_table_insert(self->item_store, (gchar *)section_id, button);
 
         brisk_menu_window_select_sections(self);
 }
@@ -246,6 +253,19 @@ static void brisk_classic_window_invalidate_filter(BriskMenuWindow *self,
         gtk_list_box_invalidate_sort(GTK_LIST_BOX(BRISK_CLASSIC_WINDOW(self)->apps));
 }
 
+/**
+ * A single item may have moved in or out of the filter, or changed order
+ */
+static void brisk_classic_window_invalidate_item(__brisk_unused__ BriskMenuWindow *self,
+                                                 GtkWidget *button)
+{
+        GtkWidget *row = gtk_widget_get_parent(button);
+
+        if (GTK_IS_LIST_BOX_ROW(row)) {
+                gtk_list_box_row_changed(GTK_LIST_BOX_ROW(row));
+        }
+}
+
 /**
  * A backend needs us to purge any data we have for it
  */
@@ -287,7 +307,7 @@ static void brisk_classic_window_reset(BriskMenuWindow *self, BriskBackend *back
                 }
 
                 local_backend_id = brisk_item_get_backend_id(item);
-                if (!g_str_equal(backend_id, local_backend_id)) {
+                if (backend_id != local_backend_id) {
                         continue;
                 }
                 local_id = brisk_item_get_id(item);
@@ -347,7 +367,10 @@ static void brisk_classic_window_class_init(BriskClassicWindowClass *klazz)
         b_class->add_item = brisk_classic_window_add_item;
         b_class->add_section = brisk_classic_window_add_section;
         b_class->invalidate_filter = brisk_classic_window_invalidate_filter;
+        b_class->invalidate_item = brisk_classic_window_invalidate_item;
         b_class->reset = brisk_classic_window_reset;
+        b_class->set_filters_enabled = brisk_classic_window_set_filters_enabled;
+        b_class->update_session = brisk_classic_window_update_session;
 
         /* widget vtable */
         wid_class->hide = brisk_classic_window_hide;
@@ -536,8 +559,11 @@ static void brisk_classic_window_on_toggled(BriskMenuWindow *self, GtkWidget *bu
         cat = BRISK_CLASSIC_CATEGORY_BUTTON(button);
         g_object_get(cat, "section", &self->active_section, NULL);
 
+        /* Positions are per section, so they all change with it */
+        brisk_menu_window_update_sort_orders(self);
+
         /* Start the filter. */
-        brisk_classic_window_invalidate_filter(self, NULL);
+        brisk_menu_window_invalidate_filter(self, NULL);
 }
 
 /**
@@ -686,6 +712,21 @@ static void brisk_classic_window_setup_session_controls(BriskClassicWindow *self
         style = gtk_widget_get_style_context(widget);
         gtk_style_context_add_class(style, GTK_STYLE_CLASS_FLAT);
         gtk_style_context_add_class(style, "session-button");
+
+        /* Nothing is usable until the session services reply */
+        brisk_classic_window_update_session(BRISK_MENU_WINDOW(self));
+}
+
+/**
+ * Reflect what the session services support in our buttons
+ */
+static void brisk_classic_window_update_session(BriskMenuWindow *window)
+{
+        BriskClassicWindow *self = BRISK_CLASSIC_WINDOW(window);
+
+        gtk_widget_set_sensitive(self->button_logout, window->can_logout);
+        gtk_widget_set_sensitive(self->button_lock, window->can_lock);
+        gtk_widget_set_sensitive(self->button_shutdown, window->can_shutdown);
 }
 
 /**
@@ -696,7 +737,7 @@ static void brisk_classic_window_build_sidebar(BriskMenuWindow *self)
         GtkWidget *sep = NULL;
         autofree(gstrv) *shortcuts = NULL;
 
-        brisk_classic_window_set_filters_enabled(BRISK_CLASSIC_WINDOW(self), FALSE);
+        brisk_classic_window_set_filters_enabled(self, FALSE);
 
         /* Special leader to control group association, hidden from view */
         self->section_box_leader = gtk_radio_button_new(NULL);
@@ -724,7 +765,7 @@ static void brisk_classic_window_build_sidebar(BriskMenuWindow *self)
                 brisk_classic_window_add_shortcut(self, shortcuts[i]);
         }
 
-        brisk_classic_window_set_filters_enabled(BRISK_CLASSIC_WINDOW(self), TRUE);
+        brisk_classic_window_set_filters_enabled(self, TRUE);
 }
 
 /**
@@ -752,9 +793,11 @@ static void brisk_classic_window_add_shortcut(BriskMenuWindow *self, const gchar
 /**
  * Enable or disable the filters between building of the menus
  */
-static void brisk_classic_window_set_filters_enabled(BriskClassicWindow *self, gboolean enabled)
+static void brisk_classic_window_set_filters_enabled(BriskMenuWindow *window, gboolean enabled)
 {
-        BRISK_MENU_WINDOW(self)->filtering = enabled;
+        BriskClassicWindow *self = BRISK_CLASSIC_WINDOW(window);
+
+        window->filtering = enabled;
         if (enabled) {
                 gtk_list_box_set_filter_func(GTK_LIST_BOX(self->apps),
                                              brisk_classic_window_filter_apps,
@@ -776,7 +819,7 @@ static void brisk_classic_window_set_filters_enabled(BriskClassicWindow *self, g
  * Responsible for filtering the selection based on active group or search
  * term.
  */
-__brisk_pure__ static gboolean brisk_classic_window_filter_apps(GtkListBoxRow *row, gpointer v)
+static gboolean brisk_classic_window_filter_apps(GtkListBoxRow *row, gpointer v)
 {
         BriskMenuWindow *self = NULL;
         GtkWidget *child = NULL;
@@ -787,6 +830,8 @@ __brisk_pure__ static gboolean brisk_classic_window_filter_apps(GtkListBoxRow *r
                 return FALSE;
         }
 
+        brisk_trace_span("window.filter");
+
         /* Grab our Entry widget */
         child = gtk_bin_get_child(GTK_BIN(row));
 
@@ -796,20 +841,18 @@ __brisk_pure__ static gboolean brisk_classic_window_filter_apps(GtkListBoxRow *r
 static gint brisk_classic_window_sort(GtkListBoxRow *row1, GtkListBoxRow *row2, gpointer v)
 {
         GtkWidget *child1, *child2 = NULL;
-        BriskItem *itemA, *itemB = NULL;
-        autofree(gchar) *nameA = NULL;
-        autofree(gchar) *nameB = NULL;
         BriskMenuWindow *self = NULL;
 
+        brisk_trace_span("window.sort");
+
         self = BRISK_MENU_WINDOW(v);
 
         child1 = gtk_bin_get_child(GTK_BIN(row1));
         child2 = gtk_bin_get_child(GTK_BIN(row2));
 
-        g_object_get(child1, "item", &itemA, NULL);
-        g_object_get(child2, "item", &itemB, NULL);
-
-        return brisk_menu_window_sort(self, itemA, itemB);
+        return brisk_menu_window_sort(self,
+                                      BRISK_MENU_ENTRY_BUTTON(child1),
+                                      BRISK_MENU_ENTRY_BUTTON(child2));
 }
 
 /*
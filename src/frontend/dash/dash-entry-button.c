@@ -16,6 +16,7 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "dash-entry-button.h"
+#include "trace.h"
 #include <glib/gi18n.h>
 BRISK_END_PEDANTIC
 
@@ -31,6 +32,8 @@ static void brisk_dash_entry_button_constructed(GObject *obj)
 
         self = BRISK_DASH_ENTRY_BUTTON(obj);
 
+        brisk_trace_span("button.icon");
+
         icon = brisk_item_get_icon(BRISK_MENU_ENTRY_BUTTON(self)->item);
         if (icon) {
                 gtk_image_set_from_gicon(GTK_IMAGE(self->image),
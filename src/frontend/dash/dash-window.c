@@ -18,6 +18,7 @@ BRISK_BEGIN_PEDANTIC
 #include "category-button.h"
 #include "dash-entry-button.h"
 #include "dash-window.h"
+#include "trace.h"
 #include <glib/gi18n.h>
 BRISK_END_PEDANTIC
 
@@ -31,7 +32,7 @@ static void brisk_dash_window_load_css(GtkSettings *settings, const gchar *key,
                                        BriskDashWindow *self);
 static void brisk_dash_window_key_activate(BriskDashWindow *self, gpointer v);
 static void brisk_dash_window_activated(BriskMenuWindow *self, GtkFlowBoxChild *row, gpointer v);
-static void brisk_dash_window_set_filters_enabled(BriskDashWindow *self, gboolean enabled);
+static void brisk_dash_window_set_filters_enabled(BriskMenuWindow *window, gboolean enabled);
 static gboolean brisk_dash_window_filter_apps(GtkFlowBoxChild *row, gpointer v);
 static gint brisk_dash_window_sort(GtkFlowBoxChild *row1, GtkFlowBoxChild *row2, gpointer v);
 
@@ -149,10 +150,15 @@ static void brisk_dash_window_add_item(BriskMenuWindow *self, BriskItem *item,
                                  "show-context-menu",
                                  G_CALLBACK(brisk_menu_window_show_context),
                                  self);
+        g_signal_connect_swapped(button,
+                                 "item-dropped",
+                                 G_CALLBACK(brisk_menu_window_item_dropped),
+                                 self);
+        brisk_menu_window_update_sort_order(self, BRISK_MENU_ENTRY_BUTTON(button));
         gtk_container_add(GTK_CONTAINER(BRISK_DASH_WINDOW(self)->apps), GTK_WIDGET(button));
         gtk_widget_show_all(GTK_WIDGET(button));
 
-        g_hash_table_insert(self->item_store, g_strdup(item_id), GTK_WIDGET(button));
+        g_hash_table_insert(self->item_store, (gchar *)item_id, GTK_WIDGET(button));
 }
 
 /**
@@ -176,12 +182,12 @@ static void brisk_dash_window_add_section(BriskMenuWindow *self, BriskSection *s
         button = brisk_dash_category_button_new(section);
         gtk_radio_button_join_group(GTK_RADIO_BUTTON(button),
                                     GTK_RADIO_BUTTON(self->section_box_leader));
-        gtk_box_pack_start(GTK_BOX(box_target), button, FALSE, FALSE, 0);
+        brisk_menu_window_pack_section(box_target, button, section);
         brisk_dash_window_associate_category(self, button);
         gtk_widget_show_all(button);
 
         /* Avoid new dupes */
-        g_hash_table_insert(self->item_store, g_strdup(section_id), button);
+        g_hash_table_insert(self->item_store, (gchar *)section_id, button);
 
         brisk_menu_window_select_sections(self);
 }
@@ -196,6 +202,19 @@ static void brisk_dash_window_invalidate_filter(BriskMenuWindow *self,
         gtk_flow_box_invalidate_sort(GTK_FLOW_BOX(BRISK_DASH_WINDOW(self)->apps));
 }
 
+/**
+ * A single item may have moved in or out of the filter, or changed order
+ */
+static void brisk_dash_window_invalidate_item(__brisk_unused__ BriskMenuWindow *self,
+                                              GtkWidget *button)
+{
+        GtkWidget *child = gtk_widget_get_parent(button);
+
+        if (GTK_IS_FLOW_BOX_CHILD(child)) {
+                gtk_flow_box_child_changed(GTK_FLOW_BOX_CHILD(child));
+        }
+}
+
 /**
  * A backend needs us to purge any data we have for it
  */
@@ -237,7 +256,7 @@ static void brisk_dash_window_reset(BriskMenuWindow *self, BriskBackend *backend
                 }
 
                 local_backend_id = brisk_item_get_backend_id(item);
-                if (!g_str_equal(backend_id, local_backend_id)) {
+                if (backend_id != local_backend_id) {
                         continue;
                 }
                 local_id = brisk_item_get_id(item);
@@ -303,7 +322,9 @@ static void brisk_dash_window_class_init(BriskDashWindowClass *klazz)
         b_class->add_item = brisk_dash_window_add_item;
         b_class->add_section = brisk_dash_window_add_section;
         b_class->invalidate_filter = brisk_dash_window_invalidate_filter;
+        b_class->invalidate_item = brisk_dash_window_invalidate_item;
         b_class->reset = brisk_dash_window_reset;
+        b_class->set_filters_enabled = brisk_dash_window_set_filters_enabled;
 
         wid_class->hide = brisk_dash_window_hide;
 }
@@ -430,7 +451,7 @@ static void brisk_dash_window_init(BriskDashWindow *self)
                 gtk_widget_set_visual(GTK_WIDGET(self), vis);
         }
 
-        brisk_dash_window_set_filters_enabled(self, FALSE);
+        brisk_dash_window_set_filters_enabled(BRISK_MENU_WINDOW(self), FALSE);
 
         /* Special leader to control group association, hidden from view */
         base->section_box_leader = gtk_radio_button_new(NULL);
@@ -442,7 +463,7 @@ static void brisk_dash_window_init(BriskDashWindow *self)
         gtk_widget_set_no_show_all(base->section_box_leader, TRUE);
         gtk_widget_hide(base->section_box_leader);
 
-        brisk_dash_window_set_filters_enabled(self, TRUE);
+        brisk_dash_window_set_filters_enabled(BRISK_MENU_WINDOW(self), TRUE);
 
         /* Hook up keyboard events */
         g_signal_connect(self,
@@ -501,8 +522,11 @@ static void brisk_dash_window_on_toggled(BriskMenuWindow *self, GtkWidget *butto
         cat = BRISK_DASH_CATEGORY_BUTTON(button);
         g_object_get(cat, "section", &self->active_section, NULL);
 
+        /* Positions are per section, so they all change with it */
+        brisk_menu_window_update_sort_orders(self);
+
         /* Start the filter. */
-        brisk_dash_window_invalidate_filter(self, NULL);
+        brisk_menu_window_invalidate_filter(self, NULL);
 }
 
 /**
@@ -618,9 +642,11 @@ static void brisk_dash_window_activated(__brisk_unused__ BriskMenuWindow *self,
 /**
  * Enable or disable the filters between building of the menus
  */
-static void brisk_dash_window_set_filters_enabled(BriskDashWindow *self, gboolean enabled)
+static void brisk_dash_window_set_filters_enabled(BriskMenuWindow *window, gboolean enabled)
 {
-        BRISK_MENU_WINDOW(self)->filtering = enabled;
+        BriskDashWindow *self = BRISK_DASH_WINDOW(window);
+
+        window->filtering = enabled;
         if (enabled) {
                 gtk_flow_box_set_filter_func(GTK_FLOW_BOX(self->apps),
                                              brisk_dash_window_filter_apps,
@@ -642,7 +668,7 @@ static void brisk_dash_window_set_filters_enabled(BriskDashWindow *self, gboolea
  * Responsible for filtering the selection based on active group or search
  * term.
  */
-__brisk_pure__ static gboolean brisk_dash_window_filter_apps(GtkFlowBoxChild *row, gpointer v)
+static gboolean brisk_dash_window_filter_apps(GtkFlowBoxChild *row, gpointer v)
 {
         BriskMenuWindow *self = NULL;
         GtkWidget *child = NULL;
@@ -653,6 +679,8 @@ __brisk_pure__ static gboolean brisk_dash_window_filter_apps(GtkFlowBoxChild *ro
                 return FALSE;
         }
 
+        brisk_trace_span("window.filter");
+
         /* Grab our Entry widget */
         child = gtk_bin_get_child(GTK_BIN(row));
 
@@ -662,20 +690,18 @@ __brisk_pure__ static gboolean brisk_dash_window_filter_apps(GtkFlowBoxChild *ro
 static gint brisk_dash_window_sort(GtkFlowBoxChild *row1, GtkFlowBoxChild *row2, gpointer v)
 {
         GtkWidget *child1, *child2 = NULL;
-        BriskItem *itemA, *itemB = NULL;
-        autofree(gchar) *nameA = NULL;
-        autofree(gchar) *nameB = NULL;
         BriskMenuWindow *self = NULL;
 
+        brisk_trace_span("window.sort");
+
         self = BRISK_MENU_WINDOW(v);
 
         child1 = gtk_bin_get_child(GTK_BIN(row1));
         child2 = gtk_bin_get_child(GTK_BIN(row2));
 
-        g_object_get(child1, "item", &itemA, NULL);
-        g_object_get(child2, "item", &itemB, NULL);
-
-        return brisk_menu_window_sort(self, itemA, itemB);
+        return brisk_menu_window_sort(self,
+                                      BRISK_MENU_ENTRY_BUTTON(child1),
+                                      BRISK_MENU_ENTRY_BUTTON(child2));
 }
 
 /*
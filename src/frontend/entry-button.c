@@ -26,11 +26,16 @@ static void brisk_menu_entry_drag_end(GtkWidget *widget, GdkDragContext *context
 static void brisk_menu_entry_drag_data(GtkWidget *widget, GdkDragContext *context,
                                        GtkSelectionData *data, guint info, guint time);
 static gboolean brisk_menu_entry_button_release_event(GtkWidget *wid, GdkEventButton *event);
+static gboolean brisk_menu_entry_drag_motion(GtkWidget *widget, GdkDragContext *context, gint x,
+                                             gint y, guint time);
+static void brisk_menu_entry_drag_leave(GtkWidget *widget, GdkDragContext *context, guint time);
+static gboolean brisk_menu_entry_drag_drop(GtkWidget *widget, GdkDragContext *context, gint x,
+                                           gint y, guint time);
 
 /**
  * IDs for our signals
  */
-enum { ENTRY_BUTTON_SIGNAL_CONTEXT_MENU = 0, N_SIGNALS };
+enum { ENTRY_BUTTON_SIGNAL_CONTEXT_MENU = 0, ENTRY_BUTTON_SIGNAL_ITEM_DROPPED, N_SIGNALS };
 
 static guint entry_button_signals[N_SIGNALS] = { 0 };
 
@@ -112,6 +117,9 @@ static void brisk_menu_entry_button_class_init(BriskMenuEntryButtonClass *klazz)
         wid_class->drag_data_get = brisk_menu_entry_drag_data;
         wid_class->drag_begin = brisk_menu_entry_drag_begin;
         wid_class->drag_end = brisk_menu_entry_drag_end;
+        wid_class->drag_motion = brisk_menu_entry_drag_motion;
+        wid_class->drag_leave = brisk_menu_entry_drag_leave;
+        wid_class->drag_drop = brisk_menu_entry_drag_drop;
         wid_class->button_release_event = brisk_menu_entry_button_release_event;
 
         /**
@@ -133,6 +141,26 @@ static void brisk_menu_entry_button_class_init(BriskMenuEntryButtonClass *klazz)
                          1,
                          BRISK_TYPE_ITEM);
 
+        /**
+         * BriskEntryButton::item-dropped
+         * @button: The button that was dropped onto
+         * @item: The item that was dragged here
+         *
+         * Used to notify the frontend that the user wants item moved to this
+         * button's position in the active section
+         */
+        entry_button_signals[ENTRY_BUTTON_SIGNAL_ITEM_DROPPED] =
+            g_signal_new("item-dropped",
+                         BRISK_TYPE_MENU_ENTRY_BUTTON,
+                         G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+                         G_STRUCT_OFFSET(BriskMenuEntryButtonClass, item_dropped),
+                         NULL,
+                         NULL,
+                         NULL,
+                         G_TYPE_NONE,
+                         1,
+                         BRISK_TYPE_ITEM);
+
         obj_properties[PROP_ITEM] = g_param_spec_pointer("item",
                                                          "The BriskItem",
                                                          "Corresponding BriskItem",
@@ -154,10 +182,21 @@ static void brisk_menu_entry_button_init(BriskMenuEntryButton *self)
         static const GtkTargetEntry drag_targets[] = {
                 { "text/uri-list", 0, 0 },
                 { "application/x-desktop", 0, 0 },
+                { "application/x-brisk-item", GTK_TARGET_SAME_APP, 0 },
         };
 
+        self->sort_order = -1;
+
         /* Hook up drag so users can drag .desktop from here elsewhere */
-        gtk_drag_source_set(GTK_WIDGET(self), GDK_BUTTON1_MASK, drag_targets, 2, GDK_ACTION_COPY);
+        gtk_drag_source_set(GTK_WIDGET(self),
+                            GDK_BUTTON1_MASK,
+                            drag_targets,
+                            G_N_ELEMENTS(drag_targets),
+                            GDK_ACTION_COPY);
+
+        /* And onto each other, to reorder sections that allow it. We never
+         * need the data, the source widget is right here in the same app. */
+        gtk_drag_dest_set(GTK_WIDGET(self), 0, &drag_targets[2], 1, GDK_ACTION_COPY);
 }
 
 /**
@@ -199,11 +238,16 @@ static gboolean hide_toplevel(GtkWidget *widget)
 /**
  * Clean up the ref'd icon
  */
-static void brisk_menu_entry_drag_end(__brisk_unused__ GtkWidget *widget, GdkDragContext *context)
+static void brisk_menu_entry_drag_end(GtkWidget *widget, GdkDragContext *context)
 {
         GIcon *icon = NULL;
 
-        g_idle_add((GSourceFunc)hide_toplevel, widget);
+        /* Reordering keeps the menu open, anywhere else gets it out of the way.
+         * The drop only sees the destination's context, so it marks us. */
+        if (!g_object_get_data(G_OBJECT(widget), "_drag_reorder_brisk")) {
+                g_idle_add((GSourceFunc)hide_toplevel, widget);
+        }
+        g_object_set_data(G_OBJECT(widget), "_drag_reorder_brisk", NULL);
 
         icon = g_object_get_data(G_OBJECT(context), "_drag_icon_brisk");
         if (!icon) {
@@ -230,6 +274,72 @@ static void brisk_menu_entry_drag_data(GtkWidget *widget, __brisk_unused__ GdkDr
         gtk_selection_data_set_uris(data, (gchar **)uris);
 }
 
+/**
+ * Only another of our buttons may be dropped here, and only while both
+ * have a place in the active section's order
+ */
+static BriskMenuEntryButton *brisk_menu_entry_drag_source(BriskMenuEntryButton *self,
+                                                          GdkDragContext *context)
+{
+        GtkWidget *source = gtk_drag_get_source_widget(context);
+        BriskMenuEntryButton *button = NULL;
+
+        if (!source || !BRISK_IS_MENU_ENTRY_BUTTON(source) || source == GTK_WIDGET(self)) {
+                return NULL;
+        }
+
+        button = BRISK_MENU_ENTRY_BUTTON(source);
+        if (button->sort_order < 0 || self->sort_order < 0) {
+                return NULL;
+        }
+        return button;
+}
+
+static gboolean brisk_menu_entry_drag_motion(GtkWidget *widget, GdkDragContext *context,
+                                             __brisk_unused__ gint x, __brisk_unused__ gint y,
+                                             guint time)
+{
+        BriskMenuEntryButton *self = BRISK_MENU_ENTRY_BUTTON(widget);
+
+        if (!brisk_menu_entry_drag_source(self, context)) {
+                gdk_drag_status(context, 0, time);
+                return FALSE;
+        }
+
+        gdk_drag_status(context, GDK_ACTION_COPY, time);
+        gtk_drag_highlight(widget);
+        return TRUE;
+}
+
+static void brisk_menu_entry_drag_leave(GtkWidget *widget, __brisk_unused__ GdkDragContext *context,
+                                        __brisk_unused__ guint time)
+{
+        gtk_drag_unhighlight(widget);
+}
+
+/**
+ * The drop itself is all we need, the frontend moves the item
+ */
+static gboolean brisk_menu_entry_drag_drop(GtkWidget *widget, GdkDragContext *context,
+                                           __brisk_unused__ gint x, __brisk_unused__ gint y,
+                                           guint time)
+{
+        BriskMenuEntryButton *self = BRISK_MENU_ENTRY_BUTTON(widget);
+        BriskMenuEntryButton *source = brisk_menu_entry_drag_source(self, context);
+
+        if (!source) {
+                return FALSE;
+        }
+
+        g_object_set_data(G_OBJECT(source), "_drag_reorder_brisk", GINT_TO_POINTER(TRUE));
+        g_signal_emit(self,
+                      entry_button_signals[ENTRY_BUTTON_SIGNAL_ITEM_DROPPED],
+                      0,
+                      source->item);
+        gtk_drag_finish(context, TRUE, FALSE, time);
+        return TRUE;
+}
+
 static gboolean brisk_menu_entry_button_release_event(GtkWidget *widget,
                                                       GdkEventButton *event_button)
 {
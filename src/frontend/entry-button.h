@@ -25,6 +25,7 @@ typedef struct _BriskMenuEntryButtonClass BriskMenuEntryButtonClass;
 struct _BriskMenuEntryButtonClass {
         GtkButtonClass parent_class;
         void (*show_context_menu)(BriskMenuEntryButton *button, BriskItem *item);
+        void (*item_dropped)(BriskMenuEntryButton *button, BriskItem *item);
 };
 
 /**
@@ -34,6 +35,7 @@ struct _BriskMenuEntryButton {
         GtkButton parent;
         BriskMenuLauncher *launcher;
         BriskItem *item;
+        gint sort_order; /**<Position in the active section's own order, or -1 */
 };
 
 #define BRISK_TYPE_MENU_ENTRY_BUTTON brisk_menu_entry_button_get_type()
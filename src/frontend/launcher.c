@@ -16,6 +16,7 @@
 BRISK_BEGIN_PEDANTIC
 #include "launcher.h"
 #include "menu-private.h"
+#include "trace.h"
 #include <gtk/gtk.h>
 BRISK_END_PEDANTIC
 
@@ -30,6 +31,15 @@ struct _BriskMenuLauncher {
         GObject parent;
         GdkAppLaunchContext *context;
         GdkDisplay *display;
+
+        /* The launch waiting for the menu to get out of the way */
+        BriskItem *pending_item;
+        GAppInfo *pending_app;
+        GdkScreen *pending_screen; /**<Screen the launch was asked for on */
+        GIcon *pending_icon;       /**<Icon for its startup notification */
+        guint32 pending_timestamp; /**<Time of the event that asked for it */
+        guint pending_id;
+        gint64 launch_start; /**<When the current launch was asked for, 0 once reported */
 };
 
 G_DEFINE_TYPE(BriskMenuLauncher, brisk_menu_launcher, G_TYPE_OBJECT)
@@ -59,6 +69,14 @@ static void brisk_menu_launcher_dispose(GObject *obj)
         BriskMenuLauncher *self = NULL;
 
         self = BRISK_MENU_LAUNCHER(obj);
+        if (self->pending_id > 0) {
+                g_source_remove(self->pending_id);
+                self->pending_id = 0;
+        }
+        g_clear_object(&self->pending_item);
+        g_clear_object(&self->pending_app);
+        g_clear_object(&self->pending_screen);
+        g_clear_object(&self->pending_icon);
         g_clear_object(&self->context);
 
         G_OBJECT_CLASS(brisk_menu_launcher_parent_class)->dispose(obj);
@@ -99,48 +117,148 @@ static void brisk_menu_launcher_init(BriskMenuLauncher *self)
                                  self);
 }
 
-static void brisk_menu_launcher_init_context(BriskMenuLauncher *self, GtkWidget *parent,
-                                             GIcon *icon)
+/**
+ * Prepare the shared context for the pending launch. This only happens once
+ * it actually runs, so a launch flushed out of the queue by a newer one still
+ * gets its own icon and timestamp for startup notification.
+ */
+static void brisk_menu_launcher_init_context(BriskMenuLauncher *self)
+{
+        gdk_app_launch_context_set_screen(self->context, self->pending_screen);
+        gdk_app_launch_context_set_icon(self->context, self->pending_icon);
+        gdk_app_launch_context_set_timestamp(self->context, self->pending_timestamp);
+}
+
+/**
+ * Report the outcome of the current launch, unless the context's own
+ * signals got there first
+ */
+static void brisk_menu_launcher_report(BriskMenuLauncher *self, gboolean launched)
+{
+        if (self->launch_start == 0) {
+                return;
+        }
+
+        if (launched) {
+                brisk_menu_window_latency_record(BRISK_MENU_LATENCY_LAUNCH,
+                                                 g_get_monotonic_time() - self->launch_start);
+        } else {
+                brisk_menu_window_latency_failed(BRISK_MENU_LATENCY_LAUNCH);
+        }
+        self->launch_start = 0;
+}
+
+/**
+ * The menu has been hidden and that has gone out to the display server, so
+ * it's now safe to fork without holding up the user's view.
+ */
+static gboolean brisk_menu_launcher_run_pending(BriskMenuLauncher *self)
+{
+        autofree(GError) *error = NULL;
+        gboolean launched = FALSE;
+
+        brisk_trace_span("launcher.launch");
+
+        self->pending_id = 0;
+        brisk_menu_launcher_init_context(self);
+
+        if (self->pending_item) {
+                launched = brisk_item_launch(self->pending_item,
+                                             G_APP_LAUNCH_CONTEXT(self->context));
+                g_clear_object(&self->pending_item);
+        } else if (self->pending_app) {
+                /* We may support DnD URIs onto the icons at some point, not for now. */
+                launched = g_app_info_launch(self->pending_app,
+                                             NULL,
+                                             G_APP_LAUNCH_CONTEXT(self->context),
+                                             &error);
+                if (!launched) {
+                        g_message("Failed to launch %s: %s",
+                                  g_app_info_get_id(self->pending_app),
+                                  error->message);
+                }
+                g_clear_object(&self->pending_app);
+        }
+        g_clear_object(&self->pending_screen);
+        g_clear_object(&self->pending_icon);
+
+        /* D-Bus activated apps never emit launched, so report them here */
+        brisk_menu_launcher_report(self, launched);
+
+        return G_SOURCE_REMOVE;
+}
+
+/**
+ * Queue the launch behind the menu hiding. Default idle priority runs after
+ * GTK has processed the hide, and we flush so the display server has seen
+ * it too. Only one launch is ever pending, as the menu is gone after the
+ * first.
+ */
+static void brisk_menu_launcher_queue(BriskMenuLauncher *self, GtkWidget *parent, gint64 start,
+                                      BriskItem *item, GAppInfo *app_info, GIcon *icon)
 {
         GdkScreen *screen = NULL;
         GtkWidget *toplevel = NULL;
 
+        if (self->pending_id > 0) {
+                g_source_remove(self->pending_id);
+                brisk_menu_launcher_run_pending(self);
+        }
+
         if (parent) {
                 screen = gtk_widget_get_screen(parent);
         } else {
                 screen = gdk_screen_get_default();
         }
-
-        gdk_app_launch_context_set_screen(self->context, screen);
-        if (icon) {
-                gdk_app_launch_context_set_icon(self->context, icon);
-        }
-
         self->display = gdk_screen_get_display(screen);
 
+        self->launch_start = start;
+        self->pending_item = item ? g_object_ref(item) : NULL;
+        self->pending_app = app_info ? g_object_ref(app_info) : NULL;
+        self->pending_screen = g_object_ref(screen);
+        self->pending_icon = icon ? g_object_ref(icon) : NULL;
+        self->pending_timestamp = gtk_get_current_event_time();
+
         /* Hide the menu before kicking off the launch */
-        toplevel = gtk_widget_get_toplevel(parent);
+        toplevel = parent ? gtk_widget_get_toplevel(parent) : NULL;
         if (BRISK_IS_MENU_WINDOW(toplevel)) {
                 gtk_widget_hide(toplevel);
         }
+
+        gdk_display_flush(self->display);
+        self->pending_id = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
+                                           (GSourceFunc)brisk_menu_launcher_run_pending,
+                                           self,
+                                           NULL);
 }
 
 void brisk_menu_launcher_start_item(BriskMenuLauncher *self, GtkWidget *parent, BriskItem *item)
 {
-        brisk_menu_launcher_init_context(self, parent, (GIcon *)brisk_item_get_icon(item));
+        gint64 start = g_get_monotonic_time();
+
+        brisk_trace_span("launcher.start-item");
 
         /* The item itself will basically do similar to g_app_info_launch using our
-         * context now it's prepared.
+         * context once it's prepared.
          */
-        brisk_item_launch(item, G_APP_LAUNCH_CONTEXT(self->context));
+        brisk_menu_launcher_queue(self,
+                                  parent,
+                                  start,
+                                  item,
+                                  NULL,
+                                  (GIcon *)brisk_item_get_icon(item));
 }
 
 void brisk_menu_launcher_start(BriskMenuLauncher *self, GtkWidget *parent, GAppInfo *app_info)
 {
-        brisk_menu_launcher_init_context(self, parent, g_app_info_get_icon(app_info));
-
-        /* We may support DnD URIs onto the icons at some point, not for now. */
-        g_app_info_launch(app_info, NULL, G_APP_LAUNCH_CONTEXT(self->context), NULL);
+        gint64 start = g_get_monotonic_time();
+
+        brisk_menu_launcher_queue(self,
+                                  parent,
+                                  start,
+                                  NULL,
+                                  app_info,
+                                  g_app_info_get_icon(app_info));
 }
 
 /**
@@ -176,6 +294,8 @@ static void brisk_menu_launcher_app_launched(BriskMenuLauncher *self,
                 }
         }
 
+        brisk_menu_launcher_report(self, TRUE);
+
         if (!startup_id) {
                 return;
         }
@@ -193,6 +313,7 @@ static void brisk_menu_launcher_app_failed(BriskMenuLauncher *self, gchar *start
                                            __brisk_unused__ GAppLaunchContext *context)
 {
         g_message("Startup failure of %s", startup_id);
+        brisk_menu_launcher_report(self, FALSE);
         gdk_display_notify_startup_complete(self->display, startup_id);
 }
 
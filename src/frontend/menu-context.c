@@ -16,6 +16,7 @@
 BRISK_BEGIN_PEDANTIC
 #include "menu-private.h"
 #include "menu-window.h"
+#include "trace.h"
 #include <gtk/gtk.h>
 BRISK_END_PEDANTIC
 
@@ -24,49 +25,42 @@ BRISK_END_PEDANTIC
 DEF_AUTOFREE(GMenu, g_object_unref)
 
 /**
- * brisk_menu_window_context_hide:
- *
- * Existing menu has gone bye-bye, so clear it up. Typically this only happens
- * when the new menu is about to be inserted, and not when the menu is actually
- * closed.
+ * A context menu built for a single item, reused until it goes stale
  */
-static void brisk_menu_window_context_hide(GtkWidget *attached, GtkMenu *menu)
-{
-        BriskMenuWindow *self = BRISK_MENU_WINDOW(attached);
+typedef struct BriskMenuContext {
+        GtkWidget *menu;           /**<Popup for the item, NULL when there is nothing to show */
+        GSimpleActionGroup *group; /**<Actions the menu invokes */
+} BriskMenuContext;
 
-        /* Pop any existing action group */
-        gtk_widget_insert_action_group(attached, BRISK_ACTION_GROUP, NULL);
-        gtk_widget_destroy(GTK_WIDGET(menu));
-        self->context_group = NULL;
+static void brisk_menu_context_free(BriskMenuContext *context)
+{
+        g_clear_pointer(&context->menu, gtk_widget_destroy);
+        g_clear_object(&context->group);
+        g_free(context);
 }
 
 /**
- * brisk_menu_window_show_context:
- *
- * Menu button has requested a context menu be shown for the given item
- *
- * WARNING: this is leaky right now and is a port of the original PR behaviour
+ * Ask every backend for its actions on the item, exactly once
  */
-void brisk_menu_window_show_context(BriskMenuWindow *self, BriskItem *item,
-                                    __brisk_unused__ BriskMenuEntryButton *button)
+static BriskMenuContext *brisk_menu_window_build_context(BriskMenuWindow *self, BriskItem *item)
 {
         GHashTableIter iter = { 0 };
         __brisk_unused__ gpointer key;
         BriskBackend *backend = NULL;
-        GSimpleActionGroup *group = NULL;
+        BriskMenuContext *context = NULL;
         autofree(GMenu) *simple_menu = NULL;
 
-        g_clear_pointer(&self->context_menu, gtk_widget_destroy);
-
-        group = g_simple_action_group_new();
-        self->context_group = G_ACTION_GROUP(group);
+        context = g_new0(BriskMenuContext, 1);
+        context->group = g_simple_action_group_new();
 
         /* For now, iterate all the backends and stick the actions in */
         g_hash_table_iter_init(&iter, self->backends);
         while (g_hash_table_iter_next(&iter, (void **)&key, (void **)&backend)) {
                 autofree(GMenu) *section = NULL;
 
-                section = brisk_backend_get_item_actions(backend, item, G_ACTION_GROUP(group));
+                section = brisk_backend_get_item_actions(backend,
+                                                         item,
+                                                         G_ACTION_GROUP(context->group));
                 if (!section) {
                         continue;
                 }
@@ -79,18 +73,115 @@ void brisk_menu_window_show_context(BriskMenuWindow *self, BriskItem *item,
                 g_menu_append_section(simple_menu, NULL, G_MENU_MODEL(section));
         }
 
-        /* No sense displaying an empty menu */
+        /* No sense displaying an empty menu, but remember that it's empty */
         if (!simple_menu) {
+                return context;
+        }
+
+        context->menu = gtk_menu_new_from_model(G_MENU_MODEL(simple_menu));
+        gtk_menu_attach_to_widget(GTK_MENU(context->menu), GTK_WIDGET(self), NULL);
+        return context;
+}
+
+/**
+ * Destroy stale menus once we're clear of whatever signal emission caused
+ * them to go stale, which is quite often the activation of one of their
+ * own items.
+ */
+static void brisk_menu_window_flush_context(BriskMenuWindow *self)
+{
+        for (GSList *elem = self->context_stale; elem; elem = elem->next) {
+                BriskMenuContext *context = elem->data;
+
+                if (context->menu && context->menu == self->context_menu) {
+                        self->context_menu = NULL;
+                        self->context_group = NULL;
+                        gtk_widget_insert_action_group(GTK_WIDGET(self), BRISK_ACTION_GROUP, NULL);
+                }
+                brisk_menu_context_free(context);
+        }
+        g_slist_free(self->context_stale);
+        self->context_stale = NULL;
+}
+
+static gboolean brisk_menu_window_flush_context_idle(BriskMenuWindow *self)
+{
+        self->context_stale_id = 0;
+        brisk_menu_window_flush_context(self);
+        return G_SOURCE_REMOVE;
+}
+
+/**
+ * brisk_menu_window_invalidate_context:
+ *
+ * Forget the cached context menu for the item ID, or for every item when
+ * @id is NULL, so that it's rebuilt on the next right click
+ */
+void brisk_menu_window_invalidate_context(BriskMenuWindow *self, const gchar *id)
+{
+        GHashTableIter iter = { 0 };
+        gpointer value = NULL;
+
+        if (!self->context_cache) {
                 return;
         }
 
-        /* Push in the action group for invokables */
-        gtk_widget_insert_action_group(GTK_WIDGET(self), BRISK_ACTION_GROUP, G_ACTION_GROUP(group));
+        if (id) {
+                id = g_intern_string(id);
+                value = g_hash_table_lookup(self->context_cache, id);
+                if (!value) {
+                        return;
+                }
+                g_hash_table_steal(self->context_cache, id);
+                self->context_stale = g_slist_prepend(self->context_stale, value);
+        } else {
+                g_hash_table_iter_init(&iter, self->context_cache);
+                while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                        self->context_stale = g_slist_prepend(self->context_stale, value);
+                        g_hash_table_iter_steal(&iter);
+                }
+        }
+
+        if (self->context_stale && self->context_stale_id == 0) {
+                self->context_stale_id =
+                    g_idle_add((GSourceFunc)brisk_menu_window_flush_context_idle, self);
+        }
+}
+
+/**
+ * brisk_menu_window_show_context:
+ *
+ * Menu button has requested a context menu be shown for the given item.
+ * Menus and their action groups are built the first time an item is
+ * right clicked, then reused until a backend tells us they're stale.
+ */
+void brisk_menu_window_show_context(BriskMenuWindow *self, BriskItem *item,
+                                    __brisk_unused__ BriskMenuEntryButton *button)
+{
+        BriskMenuContext *context = NULL;
+        const gchar *id = NULL;
+
+        brisk_trace_span("window.context-menu");
 
-        self->context_menu = gtk_menu_new_from_model(G_MENU_MODEL(simple_menu));
-        gtk_menu_attach_to_widget(GTK_MENU(self->context_menu),
-                                  GTK_WIDGET(self),
-                                  brisk_menu_window_context_hide);
+        id = brisk_item_get_id(item);
+        context = g_hash_table_lookup(self->context_cache, id);
+        if (!context) {
+                context = brisk_menu_window_build_context(self, item);
+                g_hash_table_insert(self->context_cache, (gpointer)id, context);
+        }
+
+        if (!context->menu) {
+                return;
+        }
+
+        /* Push in the action group for invokables */
+        if (self->context_group != G_ACTION_GROUP(context->group)) {
+                self->context_group = G_ACTION_GROUP(context->group);
+                gtk_widget_insert_action_group(GTK_WIDGET(self),
+                                               BRISK_ACTION_GROUP,
+                                               self->context_group);
+        }
+        self->context_menu = context->menu;
 
         /* Show it now */
         gtk_menu_popup(GTK_MENU(self->context_menu),
@@ -107,9 +198,49 @@ void brisk_menu_window_show_context(BriskMenuWindow *self, BriskItem *item,
  *
  * Set up the basics for handling context menus
  */
-void brisk_menu_window_configure_context(__brisk_unused__ BriskMenuWindow *self)
+void brisk_menu_window_configure_context(BriskMenuWindow *self)
 {
-        /* TODO: Init bits */
+        /* Item IDs are interned, so we key the cache on the pointer itself */
+        self->context_cache = g_hash_table_new_full(g_direct_hash,
+                                                    g_direct_equal,
+                                                    NULL,
+                                                    (GDestroyNotify)brisk_menu_context_free);
+}
+
+/**
+ * brisk_menu_window_dispose_context:
+ *
+ * Tear down every cached context menu
+ */
+void brisk_menu_window_dispose_context(BriskMenuWindow *self)
+{
+        brisk_menu_window_invalidate_context(self, NULL);
+        brisk_menu_window_flush_context(self);
+        if (self->context_stale_id) {
+                g_source_remove(self->context_stale_id);
+                self->context_stale_id = 0;
+        }
+        g_clear_pointer(&self->context_cache, g_hash_table_unref);
+}
+
+/**
+ * brisk_menu_window_foreach_context:
+ *
+ * Visit every cached context menu, for memory accounting
+ */
+void brisk_menu_window_foreach_context(BriskMenuWindow *self, GtkCallback callback,
+                                       gpointer user_data)
+{
+        GHashTableIter iter = { 0 };
+        gpointer value = NULL;
+
+        g_hash_table_iter_init(&iter, self->context_cache);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                BriskMenuContext *context = value;
+                if (context->menu) {
+                        callback(context->menu, user_data);
+                }
+        }
 }
 
 /*
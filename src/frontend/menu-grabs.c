@@ -15,6 +15,7 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "menu-private.h"
+#include "trace.h"
 #include <gtk/gtk.h>
 BRISK_END_PEDANTIC
 
@@ -61,6 +62,8 @@ static gboolean brisk_menu_window_map(GtkWidget *widget, __brisk_unused__ gpoint
         GdkWindow *window = NULL;
         BriskMenuWindow *self = NULL;
 
+        brisk_trace_span("window.map");
+
         self = BRISK_MENU_WINDOW(widget);
 
         /* Forcibly request focus */
@@ -101,6 +104,8 @@ static void brisk_menu_window_grab(BriskMenuWindow *self)
                 return;
         }
 
+        brisk_trace_span("window.grab");
+
         window = gtk_widget_get_window(GTK_WIDGET(self));
         if (!window) {
                 g_warning("Attempting to grab BriskMenuWindow when not realized");
@@ -155,6 +160,8 @@ static void brisk_menu_window_grab(BriskMenuWindow *self)
                 return;
         }
 
+        brisk_trace_span("window.grab");
+
         window = gtk_widget_get_window(GTK_WIDGET(self));
         if (!window) {
                 g_warning("Attempting to grab BriskMenuWindow when not realized");
@@ -15,6 +15,11 @@ BRISK_BEGIN_PEDANTIC
 #include "menu-private.h"
 BRISK_END_PEDANTIC
 
+/**
+ * Ctrl+Shift+F12 writes the memory report when BRISK_MEMORY_REPORT is set
+ */
+#define BRISK_MEMORY_REPORT_MODS (GDK_CONTROL_MASK | GDK_SHIFT_MASK)
+
 /**
  * Handle hiding the menu when it comes to the shortcut key only.
  * i.e. the Super_L key.
@@ -24,10 +29,23 @@ gboolean brisk_menu_window_key_press(BriskMenuWindow *self, GdkEvent *event,
 {
         autofree(gchar) *accel_name = NULL;
 
+        /* Debug shortcut to write out the memory report */
+        if (brisk_menu_window_memory_report_enabled() && event->key.keyval == GDK_KEY_F12 &&
+            (event->key.state & BRISK_MEMORY_REPORT_MODS) == BRISK_MEMORY_REPORT_MODS) {
+                brisk_menu_window_report_memory(self);
+                return GDK_EVENT_STOP;
+        }
+
         if (!self->shortcut) {
                 return GDK_EVENT_PROPAGATE;
         }
 
+        /* Raw taps still reach the binder through our grab, so leave closing
+         * to hotkey_cb rather than hiding here for it to reopen us */
+        if (brisk_key_binder_is_raw(self->binder, self->shortcut)) {
+                return GDK_EVENT_PROPAGATE;
+        }
+
         accel_name = gtk_accelerator_name(event->key.keyval, event->key.state);
         if (!accel_name || g_ascii_strcasecmp(self->shortcut, accel_name) != 0) {
                 return GDK_EVENT_PROPAGATE;
@@ -72,6 +90,9 @@ static gboolean toggle_menu(BriskMenuWindow *self)
  */
 static void hotkey_cb(__brisk_unused__ GdkEvent *event, gpointer v)
 {
+        if (!gtk_widget_get_visible(GTK_WIDGET(v))) {
+                brisk_menu_window_latency_begin(BRISK_MENU_WINDOW(v), BRISK_MENU_LATENCY_OPEN);
+        }
         g_idle_add((GSourceFunc)toggle_menu, v);
 }
 
@@ -93,6 +114,18 @@ void brisk_menu_window_update_hotkey(BriskMenuWindow *self, gchar *key)
         self->shortcut = g_strdup(key);
 }
 
+/**
+ * Switch between grabbing the hotkey and watching for it through XInput2
+ */
+void brisk_menu_window_update_hotkey_mode(BriskMenuWindow *self, gboolean raw)
+{
+        BriskKeyBinderMode mode = raw ? BRISK_KEY_BINDER_MODE_RAW : BRISK_KEY_BINDER_MODE_GRAB;
+
+        if (!brisk_key_binder_set_mode(self->binder, mode)) {
+                g_message("XInput2 unavailable, falling back to grabbing the hotkey");
+        }
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -0,0 +1,404 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "menu-private.h"
+#include <errno.h>
+#include <glib-unix.h>
+#include <gtk/gtk.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+BRISK_END_PEDANTIC
+
+/**
+ * Each power of two is split into this many linear sub-buckets, which keeps
+ * every recorded value within ~6% of its true value, HDR style.
+ */
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_N_BUCKETS (LATENCY_SUB_BUCKETS + (32 - LATENCY_SUB_BITS) * LATENCY_SUB_BUCKETS)
+
+/**
+ * Histograms cover between one and two of these windows, so old samples
+ * roll out rather than dominating a long-running session.
+ */
+#define LATENCY_WINDOW (30 * 60 * G_USEC_PER_SEC)
+
+/**
+ * A rolling log-linear histogram of latencies in microseconds
+ */
+typedef struct BriskLatencyHistogram {
+        const gchar *name;                    /**<Reported name */
+        gint64 rotated;                       /**<When the current generation began */
+        guint64 counts[2][LATENCY_N_BUCKETS]; /**<Current and previous generations */
+        guint64 max[2];                       /**<Largest sample per generation */
+        guint64 failures[2];                  /**<Attempts that never completed */
+} BriskLatencyHistogram;
+
+static BriskLatencyHistogram latency_histograms[BRISK_MENU_LATENCY_N] = {
+        [BRISK_MENU_LATENCY_OPEN] = { .name = "open-to-frame" },
+        [BRISK_MENU_LATENCY_SEARCH] = { .name = "keystroke-to-frame" },
+        [BRISK_MENU_LATENCY_LAUNCH] = { .name = "click-to-spawn" },
+};
+
+/**
+ * Map a value onto its bucket
+ */
+static guint brisk_latency_bucket(guint32 value)
+{
+        guint exponent = 0;
+
+        if (value < LATENCY_SUB_BUCKETS) {
+                return value;
+        }
+
+        exponent = g_bit_storage(value) - 1;
+        return LATENCY_SUB_BUCKETS + (exponent - LATENCY_SUB_BITS) * LATENCY_SUB_BUCKETS +
+               ((value >> (exponent - LATENCY_SUB_BITS)) - LATENCY_SUB_BUCKETS);
+}
+
+/**
+ * Lowest value that lands in the given bucket
+ */
+static guint64 brisk_latency_bucket_floor(guint bucket)
+{
+        guint exponent = 0;
+        guint sub = 0;
+
+        if (bucket < LATENCY_SUB_BUCKETS) {
+                return bucket;
+        }
+
+        exponent = (bucket - LATENCY_SUB_BUCKETS) / LATENCY_SUB_BUCKETS + LATENCY_SUB_BITS;
+        sub = (bucket - LATENCY_SUB_BUCKETS) % LATENCY_SUB_BUCKETS;
+        return (guint64)(LATENCY_SUB_BUCKETS + sub) << (exponent - LATENCY_SUB_BITS);
+}
+
+/**
+ * Midpoint of a bucket, used when reporting percentiles
+ */
+static guint64 brisk_latency_bucket_value(guint bucket)
+{
+        guint64 lower = brisk_latency_bucket_floor(bucket);
+
+        if (bucket + 1 >= LATENCY_N_BUCKETS) {
+                return lower;
+        }
+        return lower + (brisk_latency_bucket_floor(bucket + 1) - lower) / 2;
+}
+
+/**
+ * Age out the previous generation once the window has passed
+ */
+static void brisk_latency_histogram_roll(BriskLatencyHistogram *self, gint64 now)
+{
+        if (self->rotated == 0) {
+                self->rotated = now;
+                return;
+        }
+
+        if (now - self->rotated < LATENCY_WINDOW) {
+                return;
+        }
+
+        if (now - self->rotated < 2 * LATENCY_WINDOW) {
+                memcpy(self->counts[1], self->counts[0], sizeof(self->counts[0]));
+                self->max[1] = self->max[0];
+                self->failures[1] = self->failures[0];
+        } else {
+                memset(self->counts[1], 0, sizeof(self->counts[1]));
+                self->max[1] = 0;
+                self->failures[1] = 0;
+        }
+
+        memset(self->counts[0], 0, sizeof(self->counts[0]));
+        self->max[0] = 0;
+        self->failures[0] = 0;
+        self->rotated = now;
+}
+
+static void brisk_latency_histogram_record(BriskLatencyHistogram *self, gint64 now, gint64 value)
+{
+        guint32 clamped = (guint32)CLAMP(value, 0, G_MAXUINT32);
+
+        brisk_latency_histogram_roll(self, now);
+        ++self->counts[0][brisk_latency_bucket(clamped)];
+        self->max[0] = MAX(self->max[0], clamped);
+}
+
+/**
+ * Write a single histogram out as one JSON object per line. Non-empty
+ * buckets are included as [floor_us, count] pairs so that dumps from many
+ * machines can be merged before computing percentiles.
+ */
+static void brisk_latency_histogram_dump(BriskLatencyHistogram *self, gint64 now, FILE *file)
+{
+        static const gdouble percentiles[] = { 0.50, 0.90, 0.99 };
+        guint64 counts[LATENCY_N_BUCKETS] = { 0 };
+        guint64 total = 0;
+        guint64 seen = 0;
+        guint p = 0;
+        gboolean first = TRUE;
+
+        brisk_latency_histogram_roll(self, now);
+
+        for (guint i = 0; i < LATENCY_N_BUCKETS; i++) {
+                counts[i] = self->counts[0][i] + self->counts[1][i];
+                total += counts[i];
+        }
+
+        fprintf(file, "{\"metric\": \"%s\", \"count\": %" G_GUINT64_FORMAT, self->name, total);
+
+        for (guint i = 0; i < LATENCY_N_BUCKETS && total > 0 && p < G_N_ELEMENTS(percentiles);
+             i++) {
+                seen += counts[i];
+                while (p < G_N_ELEMENTS(percentiles) &&
+                       (gdouble)seen >= percentiles[p] * (gdouble)total) {
+                        fprintf(file,
+                                ", \"p%u_us\": %" G_GUINT64_FORMAT,
+                                (guint)(percentiles[p] * 100.0),
+                                brisk_latency_bucket_value(i));
+                        ++p;
+                }
+        }
+
+        fprintf(file, ", \"max_us\": %" G_GUINT64_FORMAT, MAX(self->max[0], self->max[1]));
+        fprintf(file,
+                ", \"failures\": %" G_GUINT64_FORMAT,
+                self->failures[0] + self->failures[1]);
+
+        fputs(", \"buckets\": [", file);
+        for (guint i = 0; i < LATENCY_N_BUCKETS; i++) {
+                if (counts[i] == 0) {
+                        continue;
+                }
+                fprintf(file,
+                        "%s[%" G_GUINT64_FORMAT ", %" G_GUINT64_FORMAT "]",
+                        first ? "" : ", ",
+                        brisk_latency_bucket_floor(i),
+                        counts[i]);
+                first = FALSE;
+        }
+        fputs("]}\n", file);
+}
+
+/**
+ * brisk_menu_window_dump_latency:
+ *
+ * Write all latency histograms to BRISK_LATENCY if set (appending, so that
+ * periodic dumps accumulate), or "-" / unset for stderr.
+ */
+void brisk_menu_window_dump_latency(void)
+{
+        const gchar *path = g_getenv("BRISK_LATENCY");
+        gint64 now = g_get_monotonic_time();
+        FILE *file = stderr;
+
+        if (path && !g_str_equal(path, "-")) {
+                file = fopen(path, "a");
+                if (!file) {
+                        g_warning("Unable to write latency to %s: %s", path, strerror(errno));
+                        return;
+                }
+        }
+
+        for (guint i = 0; i < BRISK_MENU_LATENCY_N; i++) {
+                brisk_latency_histogram_dump(&latency_histograms[i], now, file);
+        }
+
+        if (file != stderr) {
+                fclose(file);
+        } else {
+                fflush(file);
+        }
+}
+
+/**
+ * SIGUSR1 asks us to dump the histograms, dispatched on the main loop
+ */
+static gboolean brisk_menu_window_latency_signal(__brisk_unused__ gpointer v)
+{
+        brisk_menu_window_dump_latency();
+        return G_SOURCE_CONTINUE;
+}
+
+/**
+ * With BRISK_LATENCY set we also dump as we exit
+ */
+static void brisk_menu_window_latency_exit(void)
+{
+        brisk_menu_window_dump_latency();
+}
+
+/**
+ * brisk_menu_window_latency_init:
+ *
+ * Hook the process for dumping the histograms, which are shared across
+ * windows, so only the first call does anything. The applet calls this at
+ * startup because the window itself may not exist yet when SIGUSR1 arrives.
+ */
+void brisk_menu_window_latency_init(void)
+{
+        static gsize init = 0;
+
+        if (!g_once_init_enter(&init)) {
+                return;
+        }
+
+        g_unix_signal_add(SIGUSR1, brisk_menu_window_latency_signal, NULL);
+        if (g_getenv("BRISK_LATENCY") != NULL) {
+                atexit(brisk_menu_window_latency_exit);
+        }
+
+        g_once_init_leave(&init, 1);
+}
+
+/**
+ * A frame has been painted, so anything we were waiting on is now visible
+ */
+static void brisk_menu_window_after_paint(__brisk_unused__ GdkFrameClock *clock,
+                                          BriskMenuWindow *self)
+{
+        gint64 now = g_get_monotonic_time();
+
+        for (guint i = 0; i < BRISK_MENU_LATENCY_N; i++) {
+                if (self->latency_start[i] == 0) {
+                        continue;
+                }
+                brisk_latency_histogram_record(&latency_histograms[i],
+                                               now,
+                                               now - self->latency_start[i]);
+                self->latency_start[i] = 0;
+        }
+}
+
+/**
+ * Our GdkWindow now exists, so we can follow its frame clock
+ */
+static void brisk_menu_window_latency_realize(GtkWidget *widget, __brisk_unused__ gpointer v)
+{
+        BriskMenuWindow *self = BRISK_MENU_WINDOW(widget);
+
+        self->frame_clock = gtk_widget_get_frame_clock(widget);
+        if (!self->frame_clock) {
+                return;
+        }
+
+        g_object_ref(self->frame_clock);
+        self->after_paint_id = g_signal_connect(self->frame_clock,
+                                                "after-paint",
+                                                G_CALLBACK(brisk_menu_window_after_paint),
+                                                self);
+}
+
+static void brisk_menu_window_latency_unrealize(GtkWidget *widget, __brisk_unused__ gpointer v)
+{
+        BriskMenuWindow *self = BRISK_MENU_WINDOW(widget);
+
+        if (!self->frame_clock) {
+                return;
+        }
+
+        g_signal_handler_disconnect(self->frame_clock, self->after_paint_id);
+        self->after_paint_id = 0;
+        g_clear_object(&self->frame_clock);
+}
+
+/**
+ * Anything still pending when we go away will never be painted
+ */
+static gboolean brisk_menu_window_latency_unmap(GtkWidget *widget,
+                                                __brisk_unused__ GdkEvent *event,
+                                                __brisk_unused__ gpointer v)
+{
+        BriskMenuWindow *self = BRISK_MENU_WINDOW(widget);
+
+        memset(self->latency_start, 0, sizeof(self->latency_start));
+        return GDK_EVENT_PROPAGATE;
+}
+
+/**
+ * Set up latency tracking for the window
+ */
+void brisk_menu_window_configure_latency(BriskMenuWindow *self)
+{
+        brisk_menu_window_latency_init();
+
+        g_signal_connect_after(self,
+                               "realize",
+                               G_CALLBACK(brisk_menu_window_latency_realize),
+                               NULL);
+        g_signal_connect(self, "unrealize", G_CALLBACK(brisk_menu_window_latency_unrealize), NULL);
+        g_signal_connect(self, "unmap-event", G_CALLBACK(brisk_menu_window_latency_unmap), NULL);
+}
+
+/**
+ * brisk_menu_window_latency_begin:
+ *
+ * Start timing until the next frame is painted. If a measurement of the
+ * same kind is already pending we keep the older start, as that is the
+ * input the user has been waiting on the longest.
+ */
+void brisk_menu_window_latency_begin(BriskMenuWindow *window, BriskMenuLatency kind)
+{
+        g_assert(window != NULL);
+        g_assert(kind < BRISK_MENU_LATENCY_N);
+
+        if (window->latency_start[kind] == 0) {
+                window->latency_start[kind] = g_get_monotonic_time();
+        }
+}
+
+/**
+ * brisk_menu_window_latency_record:
+ *
+ * Record a latency that isn't tied to a painted frame, in microseconds
+ */
+void brisk_menu_window_latency_record(BriskMenuLatency kind, gint64 value)
+{
+        g_assert(kind < BRISK_MENU_LATENCY_N);
+
+        brisk_menu_window_latency_init();
+        brisk_latency_histogram_record(&latency_histograms[kind], g_get_monotonic_time(), value);
+}
+
+/**
+ * brisk_menu_window_latency_failed:
+ *
+ * Count an attempt that failed outright, so never produced a sample
+ */
+void brisk_menu_window_latency_failed(BriskMenuLatency kind)
+{
+        g_assert(kind < BRISK_MENU_LATENCY_N);
+
+        brisk_menu_window_latency_init();
+        brisk_latency_histogram_roll(&latency_histograms[kind], g_get_monotonic_time());
+        ++latency_histograms[kind].failures[0];
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
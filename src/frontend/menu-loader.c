@@ -30,6 +30,31 @@ GtkWidget *brisk_menu_window_get_section_box(BriskMenuWindow *self, BriskBackend
         return g_hash_table_lookup(self->section_boxes, brisk_backend_get_id(backend));
 }
 
+/**
+ * Pack a category button into the section box, keeping the box sorted by
+ * section name regardless of the order in which a backend emits sections.
+ */
+void brisk_menu_window_pack_section(GtkWidget *box, GtkWidget *button, BriskSection *section)
+{
+        autofree(GList) *kids = NULL;
+        const gchar *name = brisk_section_get_name(section);
+        gint position = 0;
+
+        kids = gtk_container_get_children(GTK_CONTAINER(box));
+        for (GList *elem = kids; elem; elem = elem->next) {
+                BriskSection *sibling = NULL;
+
+                g_object_get(elem->data, "section", &sibling, NULL);
+                if (sibling && g_ascii_strcasecmp(name, brisk_section_get_name(sibling)) < 0) {
+                        break;
+                }
+                ++position;
+        }
+
+        gtk_box_pack_start(GTK_BOX(box), button, FALSE, FALSE, 0);
+        gtk_box_reorder_child(GTK_BOX(box), button, position);
+}
+
 /**
  * A backend needs us to hide the window
  */
@@ -38,6 +63,79 @@ static void brisk_menu_window_hide(BriskMenuWindow *self, __brisk_unused__ Brisk
         gtk_widget_hide(GTK_WIDGET(self));
 }
 
+/**
+ * Turn sorting and filtering back on, applying anything that was typed while
+ * they were off
+ */
+static void brisk_menu_window_resume_filters(BriskMenuWindow *self)
+{
+        BriskMenuWindowClass *klazz = BRISK_MENU_WINDOW_GET_CLASS(self);
+
+        klazz->set_filters_enabled(self, TRUE);
+
+        if (gtk_entry_get_text_length(GTK_ENTRY(self->search)) > 0) {
+                brisk_menu_window_search(self, GTK_ENTRY(self->search));
+        }
+}
+
+/**
+ * A source backend began loading, so hold off sorting and filtering until it
+ * has emitted everything, rather than paying for them on every single item.
+ * Nobody can see the rows while we're unmapped, but a reload with the menu
+ * open must keep them filtered, or every section and action shows at once.
+ */
+static void brisk_menu_window_load_started(BriskMenuWindow *self, BriskBackend *backend)
+{
+        BriskMenuWindowClass *klazz = BRISK_MENU_WINDOW_GET_CLASS(self);
+
+        if (g_hash_table_size(self->loading) == 0 && !gtk_widget_get_mapped(GTK_WIDGET(self))) {
+                klazz->set_filters_enabled(self, FALSE);
+        }
+        g_hash_table_add(self->loading, backend);
+}
+
+/**
+ * Opened mid-load, so the rest of the load has to be filtered as it arrives
+ */
+static void brisk_menu_window_load_map(BriskMenuWindow *self, __brisk_unused__ gpointer v)
+{
+        if (!self->filtering) {
+                brisk_menu_window_resume_filters(self);
+        }
+}
+
+/**
+ * Once the last loading backend has finished, sort and filter everything in
+ * one pass.
+ */
+static void brisk_menu_window_load_finished(BriskMenuWindow *self,
+                                            const BriskBackendLoadStats *stats,
+                                            BriskBackend *backend)
+{
+        g_debug("Backend '%s' loaded %u items and %u sections in %.2fms "
+                "(tree %.2fms, parse %.2fms, emit %.2fms)",
+                brisk_backend_get_id(backend),
+                stats->n_items,
+                stats->n_sections,
+                (gdouble)stats->total_time / 1000.0,
+                (gdouble)stats->tree_time / 1000.0,
+                (gdouble)stats->parse_time / 1000.0,
+                (gdouble)stats->emit_time / 1000.0);
+
+        if (!g_hash_table_remove(self->loading, backend) || g_hash_table_size(self->loading) > 0) {
+                return;
+        }
+
+        if (!self->filtering) {
+                brisk_menu_window_resume_filters(self);
+        }
+
+        /* Track how memory follows the catalog across reloads */
+        if (brisk_menu_window_memory_report_enabled()) {
+                brisk_menu_window_report_memory(self);
+        }
+}
+
 /**
  * Load the menus and place them into the window regions
  */
@@ -89,8 +187,24 @@ static void brisk_menu_window_init_backend(BriskMenuWindow *self, BriskBackend *
                                  "invalidate-filter",
                                  G_CALLBACK(brisk_menu_window_invalidate_filter),
                                  self);
+        g_signal_connect_swapped(backend,
+                                 "item-changed",
+                                 G_CALLBACK(brisk_menu_window_invalidate_item),
+                                 self);
         g_signal_connect_swapped(backend, "hide-menu", G_CALLBACK(brisk_menu_window_hide), self);
         g_signal_connect_swapped(backend, "reset", G_CALLBACK(brisk_menu_window_reset), self);
+        g_signal_connect_swapped(backend,
+                                 "actions-changed",
+                                 G_CALLBACK(brisk_menu_window_invalidate_context),
+                                 self);
+        g_signal_connect_swapped(backend,
+                                 "load-started",
+                                 G_CALLBACK(brisk_menu_window_load_started),
+                                 self);
+        g_signal_connect_swapped(backend,
+                                 "load-finished",
+                                 G_CALLBACK(brisk_menu_window_load_finished),
+                                 self);
 
         box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
         gtk_box_pack_start(GTK_BOX(self->section_box_holder), box, FALSE, FALSE, 0);
@@ -146,6 +260,8 @@ void brisk_menu_window_init_backends(BriskMenuWindow *self)
         brisk_menu_window_insert_backend(self, brisk_all_items_backend_new());
         brisk_menu_window_insert_backend(self, brisk_favourites_backend_new());
         brisk_menu_window_insert_backend(self, brisk_apps_backend_new());
+
+        g_signal_connect(self, "map", G_CALLBACK(brisk_menu_window_load_map), NULL);
 }
 
 /*
@@ -0,0 +1,346 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include "util.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+BRISK_BEGIN_PEDANTIC
+#include "entry-button.h"
+#include "menu-private.h"
+#include <errno.h>
+#include <gtk/gtk.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+BRISK_END_PEDANTIC
+
+/**
+ * Subsystems we attribute memory to
+ */
+typedef enum {
+        MEMORY_ITEMS = 0,
+        MEMORY_SECTIONS,
+        MEMORY_ITEM_STORE,
+        MEMORY_TABLES,
+        MEMORY_WIDGETS,
+        MEMORY_ICONS,
+        MEMORY_ICON_SURFACES,
+        MEMORY_SETTINGS,
+        MEMORY_N,
+} BriskMemorySubsystem;
+
+static const gchar *memory_names[MEMORY_N] = {
+        [MEMORY_ITEMS] = "items",
+        [MEMORY_SECTIONS] = "sections",
+        [MEMORY_ITEM_STORE] = "item_store",
+        [MEMORY_TABLES] = "window tables",
+        [MEMORY_WIDGETS] = "widgets",
+        [MEMORY_ICONS] = "icons",
+        [MEMORY_ICON_SURFACES] = "icon surfaces (est.)",
+        [MEMORY_SETTINGS] = "settings",
+};
+
+/**
+ * Running totals while we walk the window
+ */
+typedef struct BriskMemoryReport {
+        guint count[MEMORY_N]; /**<Objects seen per subsystem */
+        gsize bytes[MEMORY_N]; /**<Approximate bytes per subsystem */
+        GHashTable *icons;     /**<Icons already counted, they're widely shared */
+        gint scale;            /**<Window scale factor for icon surfaces */
+} BriskMemoryReport;
+
+static void brisk_menu_memory_add(BriskMemoryReport *report, BriskMemorySubsystem subsystem,
+                                  gsize bytes)
+{
+        ++report->count[subsystem];
+        report->bytes[subsystem] += bytes;
+}
+
+static gsize brisk_menu_memory_instance_size(gpointer instance)
+{
+        GTypeQuery query = { 0 };
+
+        g_type_query(G_TYPE_FROM_INSTANCE(instance), &query);
+        return query.instance_size;
+}
+
+/**
+ * GHashTable keeps a power of two sized array of keys, values and hashes
+ * at no more than 3/4 full.
+ */
+static gsize brisk_menu_memory_hash_table(GHashTable *table)
+{
+        guint slots = 8;
+
+        if (!table) {
+                return 0;
+        }
+
+        while (slots * 3 < g_hash_table_size(table) * 4) {
+                slots <<= 1;
+        }
+        return slots * (2 * sizeof(gpointer) + sizeof(guint)) + 64;
+}
+
+/**
+ * Icons are shared between items, sections and buttons, so count each once
+ */
+static void brisk_menu_memory_add_icon(BriskMemoryReport *report, const GIcon *icon)
+{
+        autofree(gchar) *serialized = NULL;
+
+        if (!icon || g_hash_table_contains(report->icons, icon)) {
+                return;
+        }
+        g_hash_table_add(report->icons, (gpointer)icon);
+
+        serialized = g_icon_to_string((GIcon *)icon);
+        brisk_menu_memory_add(report,
+                              MEMORY_ICONS,
+                              brisk_menu_memory_instance_size((gpointer)icon) +
+                                  (serialized ? strlen(serialized) + 1 : 0));
+}
+
+/**
+ * GTK caches the rendered surface for every realized image, which is the
+ * bulk of what users think of as the "icon cache"
+ */
+static void brisk_menu_memory_add_image(BriskMemoryReport *report, GtkImage *image)
+{
+        GtkImageType type = gtk_image_get_storage_type(image);
+        gint size = gtk_image_get_pixel_size(image);
+        gint width = 0;
+        gint height = 0;
+
+        if (type != GTK_IMAGE_GICON && type != GTK_IMAGE_ICON_NAME) {
+                return;
+        }
+        if (!gtk_widget_get_realized(GTK_WIDGET(image))) {
+                return;
+        }
+
+        if (size > 0) {
+                width = height = size;
+        } else {
+                GtkIconSize icon_size = GTK_ICON_SIZE_INVALID;
+                g_object_get(image, "icon-size", &icon_size, NULL);
+                gtk_icon_size_lookup(icon_size, &width, &height);
+        }
+
+        brisk_menu_memory_add(report,
+                              MEMORY_ICON_SURFACES,
+                              (gsize)(width * height * 4 * report->scale * report->scale));
+}
+
+static void brisk_menu_memory_walk_widget(GtkWidget *widget, BriskMemoryReport *report)
+{
+        brisk_menu_memory_add(report, MEMORY_WIDGETS, brisk_menu_memory_instance_size(widget));
+
+        if (GTK_IS_IMAGE(widget)) {
+                brisk_menu_memory_add_image(report, GTK_IMAGE(widget));
+        }
+
+        if (GTK_IS_CONTAINER(widget)) {
+                gtk_container_forall(GTK_CONTAINER(widget),
+                                     (GtkCallback)brisk_menu_memory_walk_widget,
+                                     report);
+        }
+}
+
+/**
+ * Every item and section the window knows about is in the item_store
+ */
+static void brisk_menu_memory_walk_store(BriskMenuWindow *self, BriskMemoryReport *report)
+{
+        GHashTableIter iter;
+        gpointer value = NULL;
+
+        brisk_menu_memory_add(report,
+                              MEMORY_ITEM_STORE,
+                              brisk_menu_memory_hash_table(self->item_store));
+
+        g_hash_table_iter_init(&iter, self->item_store);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                if (BRISK_IS_MENU_ENTRY_BUTTON(value)) {
+                        BriskItem *item = BRISK_MENU_ENTRY_BUTTON(value)->item;
+                        brisk_menu_memory_add(report,
+                                              MEMORY_ITEMS,
+                                              brisk_item_get_memory_size(item));
+                        brisk_menu_memory_add_icon(report, brisk_item_get_icon(item));
+                } else if (GTK_IS_RADIO_BUTTON(value)) {
+                        BriskSection *section = NULL;
+                        g_object_get(value, "section", &section, NULL);
+                        if (!section) {
+                                continue;
+                        }
+                        brisk_menu_memory_add(report,
+                                              MEMORY_SECTIONS,
+                                              brisk_section_get_memory_size(section));
+                        brisk_menu_memory_add_icon(report, brisk_section_get_icon(section));
+                }
+        }
+}
+
+/**
+ * Current values of every key in our schema, plus the state derived from them
+ */
+static void brisk_menu_memory_walk_settings(BriskMenuWindow *self, BriskMemoryReport *report)
+{
+        autofree(gstrv) *keys = NULL;
+
+        if (!self->settings) {
+                return;
+        }
+
+        keys = g_settings_list_keys(self->settings);
+        for (guint i = 0; keys && keys[i]; i++) {
+                GVariant *value = g_settings_get_value(self->settings, keys[i]);
+                brisk_menu_memory_add(report,
+                                      MEMORY_SETTINGS,
+                                      g_variant_get_size(value) + strlen(keys[i]) + 1);
+                g_variant_unref(value);
+        }
+
+        if (self->shortcut) {
+                brisk_menu_memory_add(report, MEMORY_SETTINGS, strlen(self->shortcut) + 1);
+        }
+}
+
+/**
+ * Bytes of heap currently handed out by malloc, 0 if unknown
+ */
+static gsize brisk_menu_memory_heap(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks;
+#elif defined(__GLIBC__)
+        struct mallinfo info = mallinfo();
+        return (gsize)info.uordblks;
+#else
+        return 0;
+#endif
+}
+
+/**
+ * Resident set size from /proc, 0 if unknown
+ */
+static gsize brisk_menu_memory_rss(void)
+{
+        autofree(gchar) *contents = NULL;
+        gulong pages = 0;
+
+        if (!g_file_get_contents("/proc/self/statm", &contents, NULL, NULL)) {
+                return 0;
+        }
+        if (sscanf(contents, "%*u %lu", &pages) != 1) {
+                return 0;
+        }
+        return (gsize)pages * (gsize)sysconf(_SC_PAGESIZE);
+}
+
+/**
+ * brisk_menu_window_memory_report_enabled:
+ *
+ * Memory reports are only written when BRISK_MEMORY_REPORT names a file,
+ * or "-" for stderr
+ */
+gboolean brisk_menu_window_memory_report_enabled(void)
+{
+        return g_getenv("BRISK_MEMORY_REPORT") != NULL;
+}
+
+/**
+ * brisk_menu_window_report_memory:
+ *
+ * Walk the window and attribute the memory it holds to each subsystem,
+ * appending the report to BRISK_MEMORY_REPORT. Anything GTK or GLib hold
+ * internally isn't visible to us, so the heap and RSS totals are included
+ * to show how much remains unattributed.
+ */
+void brisk_menu_window_report_memory(BriskMenuWindow *self)
+{
+        const gchar *path = g_getenv("BRISK_MEMORY_REPORT");
+        BriskMemoryReport report = { 0 };
+        FILE *file = stderr;
+        gsize total = 0;
+
+        if (!path) {
+                return;
+        }
+
+        report.icons = g_hash_table_new(g_direct_hash, g_direct_equal);
+        report.scale = gtk_widget_get_scale_factor(GTK_WIDGET(self));
+
+        brisk_menu_memory_walk_store(self, &report);
+        brisk_menu_memory_add(&report,
+                              MEMORY_TABLES,
+                              brisk_menu_memory_hash_table(self->section_boxes) +
+                                  brisk_menu_memory_hash_table(self->backends) +
+                                  brisk_menu_memory_hash_table(self->loading) +
+                                  brisk_menu_memory_hash_table(self->context_cache));
+        brisk_menu_memory_walk_widget(GTK_WIDGET(self), &report);
+        brisk_menu_window_foreach_context(self,
+                                          (GtkCallback)brisk_menu_memory_walk_widget,
+                                          &report);
+        brisk_menu_memory_walk_settings(self, &report);
+
+        g_hash_table_unref(report.icons);
+
+        if (!g_str_equal(path, "-")) {
+                file = fopen(path, "a");
+                if (!file) {
+                        g_warning("Unable to write memory report to %s: %s",
+                                  path,
+                                  strerror(errno));
+                        return;
+                }
+        }
+
+        fprintf(file, "# brisk memory report: %s\n", brisk_menu_window_get_id(self));
+        fprintf(file, "# subsystem\tcount\tbytes\n");
+        for (guint i = 0; i < MEMORY_N; i++) {
+                fprintf(file,
+                        "%s\t%u\t%" G_GSIZE_FORMAT "\n",
+                        memory_names[i],
+                        report.count[i],
+                        report.bytes[i]);
+                total += report.bytes[i];
+        }
+        fprintf(file, "attributed\t-\t%" G_GSIZE_FORMAT "\n", total);
+        fprintf(file, "heap\t-\t%" G_GSIZE_FORMAT "\n", brisk_menu_memory_heap());
+        fprintf(file, "rss\t-\t%" G_GSIZE_FORMAT "\n\n", brisk_menu_memory_rss());
+
+        if (file != stderr) {
+                fclose(file);
+        } else {
+                fflush(file);
+        }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,331 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "backend/favourites/favourites-backend.h"
+#include "entry-button.h"
+#include "menu-private.h"
+#include <fcntl.h>
+#include <gtk/gtk.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+BRISK_END_PEDANTIC
+
+/**
+ * How many favourites we warm up each time the menu is shown
+ */
+#define PREFETCH_MAP_COUNT 4
+
+/**
+ * How long the pointer must rest on an item before we prefetch it (ms)
+ */
+#define PREFETCH_HOVER_DELAY 200
+
+/**
+ * Don't ask for the same program again within this window, it's almost
+ * certainly still cached and we'd only be adding I/O.
+ */
+#define PREFETCH_INTERVAL (10 * 60 * G_USEC_PER_SEC)
+
+/**
+ * Requests still queued beyond this are dropped rather than piling up
+ */
+#define PREFETCH_MAX_QUEUED 8
+
+/**
+ * Nobody needs more than this of a binary cached just to start it
+ */
+#define PREFETCH_MAX_BYTES (32 * 1024 * 1024)
+
+/**
+ * From linux/ioprio.h, which isn't installed everywhere
+ */
+#define PREFETCH_IOPRIO_WHO_PROCESS 1
+#define PREFETCH_IOPRIO_CLASS_IDLE 3
+#define PREFETCH_IOPRIO_CLASS_SHIFT 13
+
+/**
+ * Shared by every window: a single worker and when each program was last
+ * prefetched, keyed by interned executable. Only touched from the main thread.
+ */
+static GThreadPool *prefetch_pool = NULL;
+static GHashTable *prefetch_times = NULL;
+
+/**
+ * Put the calling thread in the idle I/O class so we never compete with
+ * anything the user is actually waiting on
+ */
+static void brisk_menu_prefetch_set_idle(void)
+{
+#if defined(__linux__) && defined(SYS_ioprio_set)
+        static _Thread_local gboolean idle = FALSE;
+
+        if (idle) {
+                return;
+        }
+        idle = TRUE;
+
+        if (syscall(SYS_ioprio_set,
+                    PREFETCH_IOPRIO_WHO_PROCESS,
+                    0,
+                    PREFETCH_IOPRIO_CLASS_IDLE << PREFETCH_IOPRIO_CLASS_SHIFT) != 0) {
+                g_debug("Unable to lower prefetch I/O priority");
+        }
+#endif
+}
+
+/**
+ * Runs on the prefetch thread: resolve the program and ask the kernel to
+ * start reading it in. Both calls return as soon as the I/O is queued.
+ */
+static void brisk_menu_prefetch_worker(gpointer data, __brisk_unused__ gpointer v)
+{
+        const gchar *executable = data;
+        autofree(gchar) *path = NULL;
+        struct stat st = { 0 };
+        size_t len = 0;
+        int fd = -1;
+
+        brisk_menu_prefetch_set_idle();
+
+        path = g_find_program_in_path(executable);
+        if (!path) {
+                return;
+        }
+
+        fd = open(path, O_RDONLY | O_CLOEXEC | O_NOATIME);
+        if (fd < 0) {
+                fd = open(path, O_RDONLY | O_CLOEXEC);
+        }
+        if (fd < 0) {
+                return;
+        }
+
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+                goto end;
+        }
+        len = (size_t)MIN(st.st_size, PREFETCH_MAX_BYTES);
+
+#if defined(__linux__)
+        if (readahead(fd, 0, len) == 0) {
+                goto end;
+        }
+#endif
+        posix_fadvise(fd, 0, (off_t)len, POSIX_FADV_WILLNEED);
+
+end:
+        close(fd);
+}
+
+static void brisk_menu_prefetch_init_once(void)
+{
+        static gsize init = 0;
+        GError *error = NULL;
+
+        if (!g_once_init_enter(&init)) {
+                return;
+        }
+
+        /* Exclusive, so the one worker keeps its I/O priority between jobs */
+        prefetch_pool = g_thread_pool_new(brisk_menu_prefetch_worker, NULL, 1, TRUE, &error);
+        if (!prefetch_pool) {
+                g_warning("Unable to start prefetch thread: %s", error->message);
+                g_error_free(error);
+        }
+        prefetch_times = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+        g_once_init_leave(&init, 1);
+}
+
+/**
+ * brisk_menu_window_prefetch_item:
+ *
+ * Queue the program behind item to be read into the page cache, so that
+ * launching it doesn't have to wait on a cold disk. Does nothing unless the
+ * user has opted in, or if we already did so recently.
+ */
+void brisk_menu_window_prefetch_item(BriskMenuWindow *self, BriskItem *item)
+{
+        const gchar *executable = NULL;
+        gpointer last = NULL;
+        gint64 now = 0;
+
+        if (!self->prefetch || !item) {
+                return;
+        }
+
+        brisk_menu_prefetch_init_once();
+        if (!prefetch_pool) {
+                return;
+        }
+
+        executable = brisk_item_get_executable(item);
+        if (!executable) {
+                return;
+        }
+        executable = g_intern_string(executable);
+
+        now = g_get_monotonic_time();
+        if (g_hash_table_lookup_extended(prefetch_times, executable, NULL, &last) &&
+            now - *(gint64 *)last < PREFETCH_INTERVAL) {
+                return;
+        }
+        if (g_thread_pool_unprocessed(prefetch_pool) >= PREFETCH_MAX_QUEUED) {
+                return;
+        }
+
+        if (!last) {
+                last = g_new0(gint64, 1);
+                g_hash_table_insert(prefetch_times, (gpointer)executable, last);
+        }
+        *(gint64 *)last = now;
+
+        g_thread_pool_push(prefetch_pool, (gpointer)executable, NULL);
+}
+
+/**
+ * The favourites are the best guess we have at what's about to be launched
+ */
+static void brisk_menu_window_prefetch_map(BriskMenuWindow *self, __brisk_unused__ gpointer v)
+{
+        const GPtrArray *pinned = NULL;
+        BriskBackend *backend = NULL;
+
+        if (!self->prefetch) {
+                return;
+        }
+
+        backend = g_hash_table_lookup(self->backends, g_intern_static_string("favourites"));
+        if (!backend) {
+                return;
+        }
+        pinned = brisk_favourites_backend_get_pinned(BRISK_FAVOURITES_BACKEND(backend));
+
+        for (guint i = 0; i < pinned->len && i < PREFETCH_MAP_COUNT; i++) {
+                const gchar *id = g_ptr_array_index(pinned, i);
+                GtkWidget *button = g_hash_table_lookup(self->item_store, id);
+
+                if (button && BRISK_IS_MENU_ENTRY_BUTTON(button)) {
+                        brisk_menu_window_prefetch_item(self,
+                                                        BRISK_MENU_ENTRY_BUTTON(button)->item);
+                }
+        }
+}
+
+static void brisk_menu_window_prefetch_cancel_hover(BriskMenuWindow *self)
+{
+        if (self->prefetch_hover_id) {
+                g_source_remove(self->prefetch_hover_id);
+                self->prefetch_hover_id = 0;
+        }
+        self->prefetch_hover = NULL;
+}
+
+/**
+ * The pointer has rested on the item long enough. We look the button up
+ * again by ID in case it went away in the meantime.
+ */
+static gboolean brisk_menu_window_prefetch_hover_timeout(BriskMenuWindow *self)
+{
+        GtkWidget *button = g_hash_table_lookup(self->item_store, self->prefetch_hover);
+
+        self->prefetch_hover_id = 0;
+        self->prefetch_hover = NULL;
+
+        if (button && BRISK_IS_MENU_ENTRY_BUTTON(button)) {
+                brisk_menu_window_prefetch_item(self, BRISK_MENU_ENTRY_BUTTON(button)->item);
+        }
+        return G_SOURCE_REMOVE;
+}
+
+static gboolean brisk_menu_window_prefetch_enter(GtkWidget *button,
+                                                 __brisk_unused__ GdkEvent *event,
+                                                 BriskMenuWindow *self)
+{
+        BriskItem *item = BRISK_MENU_ENTRY_BUTTON(button)->item;
+
+        if (!self->prefetch) {
+                return GDK_EVENT_PROPAGATE;
+        }
+
+        brisk_menu_window_prefetch_cancel_hover(self);
+        self->prefetch_hover = brisk_item_get_id(item);
+        self->prefetch_hover_id =
+            g_timeout_add(PREFETCH_HOVER_DELAY,
+                          (GSourceFunc)brisk_menu_window_prefetch_hover_timeout,
+                          self);
+        return GDK_EVENT_PROPAGATE;
+}
+
+static gboolean brisk_menu_window_prefetch_leave(__brisk_unused__ GtkWidget *button,
+                                                 __brisk_unused__ GdkEvent *event,
+                                                 BriskMenuWindow *self)
+{
+        brisk_menu_window_prefetch_cancel_hover(self);
+        return GDK_EVENT_PROPAGATE;
+}
+
+/**
+ * brisk_menu_window_prefetch_button:
+ *
+ * Watch a newly added entry button for the pointer resting on it
+ */
+void brisk_menu_window_prefetch_button(BriskMenuWindow *self, GtkWidget *button)
+{
+        g_signal_connect(button,
+                         "enter-notify-event",
+                         G_CALLBACK(brisk_menu_window_prefetch_enter),
+                         self);
+        g_signal_connect(button,
+                         "leave-notify-event",
+                         G_CALLBACK(brisk_menu_window_prefetch_leave),
+                         self);
+}
+
+/**
+ * brisk_menu_window_configure_prefetch:
+ *
+ * Warm up the likely launches whenever the menu is shown
+ */
+void brisk_menu_window_configure_prefetch(BriskMenuWindow *self)
+{
+        g_signal_connect(self, "map", G_CALLBACK(brisk_menu_window_prefetch_map), NULL);
+}
+
+/**
+ * brisk_menu_window_dispose_prefetch:
+ *
+ * Drop any pending hover. The worker is shared and outlives the window.
+ */
+void brisk_menu_window_dispose_prefetch(BriskMenuWindow *self)
+{
+        brisk_menu_window_prefetch_cancel_hover(self);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -40,8 +40,11 @@ struct _BriskMenuWindowClass {
         void (*add_section)(BriskMenuWindow *, BriskSection *, BriskBackend *);
         void (*invalidate_filter)(BriskMenuWindow *, BriskBackend *);
         void (*reset)(BriskMenuWindow *, BriskBackend *);
+        void (*set_filters_enabled)(BriskMenuWindow *, gboolean);
+        void (*update_session)(BriskMenuWindow *);
+        void (*invalidate_item)(BriskMenuWindow *, GtkWidget *);
 
-        gpointer padding[12];
+        gpointer padding[9];
 };
 
 /**
@@ -65,6 +68,11 @@ struct _BriskMenuWindow {
         /* Whether we're in rollover mode or not */
         gboolean rollover;
 
+        /* Whether to read likely launches into the page cache ahead of time */
+        gboolean prefetch;
+        guint prefetch_hover_id;
+        const gchar *prefetch_hover; /* Interned ID under the pointer */
+
         /* Global settings for all BriskMenu instances */
         GSettings *settings;
 
@@ -72,8 +80,12 @@ struct _BriskMenuWindow {
         BriskKeyBinder *binder;
         gchar *shortcut;
 
-        GtkWidget *context_menu;
-        GActionGroup *context_group;
+        /* Context menus and their action groups, built once per item */
+        GHashTable *context_cache;
+        GSList *context_stale;
+        guint context_stale_id;
+        GtkWidget *context_menu;     /* Most recently shown, owned by the cache */
+        GActionGroup *context_group; /* Currently inserted, owned by the cache */
 
         /* Each backend gets its own box in the sidebar */
         GHashTable *section_boxes;
@@ -81,9 +93,12 @@ struct _BriskMenuWindow {
         /* Each backend is also plugged into one big map */
         GHashTable *backends;
 
-        /* Acknowledge a single ID "contains" map */
+        /* Acknowledge a single ID "contains" map, keyed by interned ID */
         GHashTable *item_store;
 
+        /* Source backends still loading, sort and filter wait until empty */
+        GHashTable *loading;
+
         /* Control launches */
         BriskMenuLauncher *launcher;
 
@@ -105,9 +120,20 @@ struct _BriskMenuWindow {
         /* Session management */
         GnomeSessionManager *session;
         MateScreenSaver *saver;
+        GCancellable *session_cancellable;
+        guint session_pending; /* Replies still outstanding */
+        gboolean can_logout;
+        gboolean can_shutdown;
+        gboolean can_lock;
+
+        /* Pending input latencies, closed on the next after-paint */
+        gint64 latency_start[BRISK_MENU_LATENCY_N];
+        GdkFrameClock *frame_clock;
+        gulong after_paint_id;
 };
 
 GtkWidget *brisk_menu_window_get_section_box(BriskMenuWindow *self, BriskBackend *backend);
+void brisk_menu_window_pack_section(GtkWidget *box, GtkWidget *button, BriskSection *section);
 
 /**
  * Update internal notion of where the parent panel is on screen
@@ -122,16 +148,37 @@ void brisk_menu_window_init_backends(BriskMenuWindow *self);
 void brisk_menu_window_remove_category(GtkWidget *widget, BriskMenuWindow *self);
 
 /* Sorting */
-gint brisk_menu_window_sort(BriskMenuWindow *self, BriskItem *itemA, BriskItem *itemB);
+gint brisk_menu_window_sort(BriskMenuWindow *self, BriskMenuEntryButton *buttonA,
+                            BriskMenuEntryButton *buttonB);
+void brisk_menu_window_update_sort_order(BriskMenuWindow *self, BriskMenuEntryButton *button);
+void brisk_menu_window_update_sort_orders(BriskMenuWindow *self);
+void brisk_menu_window_item_dropped(BriskMenuWindow *self, BriskItem *item,
+                                    BriskMenuEntryButton *target);
+gint brisk_menu_sort_items(BriskItem *itemA, BriskItem *itemB, const gchar *search_term,
+                           BriskSection *section);
 
 /* Keyboard */
 gboolean brisk_menu_window_key_press(BriskMenuWindow *self, GdkEvent *event, gpointer v);
 gboolean brisk_menu_window_key_release(BriskMenuWindow *self, GdkEvent *event, gpointer v);
 void brisk_menu_window_update_hotkey(BriskMenuWindow *self, gchar *key);
+void brisk_menu_window_update_hotkey_mode(BriskMenuWindow *self, gboolean raw);
 
 /* Global grabs */
 void brisk_menu_window_configure_grabs(BriskMenuWindow *self);
 
+/* Latency */
+void brisk_menu_window_configure_latency(BriskMenuWindow *self);
+
+/* Prefetching */
+void brisk_menu_window_configure_prefetch(BriskMenuWindow *self);
+void brisk_menu_window_dispose_prefetch(BriskMenuWindow *self);
+void brisk_menu_window_prefetch_button(BriskMenuWindow *self, GtkWidget *button);
+void brisk_menu_window_prefetch_item(BriskMenuWindow *self, BriskItem *item);
+
+/* Memory accounting */
+gboolean brisk_menu_window_memory_report_enabled(void);
+void brisk_menu_window_report_memory(BriskMenuWindow *self);
+
 /* Session controls */
 void brisk_menu_window_logout(BriskMenuWindow *self, gpointer v);
 void brisk_menu_window_shutdown(BriskMenuWindow *self, gpointer v);
@@ -146,6 +193,10 @@ void brisk_menu_window_pump_settings(BriskMenuWindow *self);
 void brisk_menu_window_show_context(BriskMenuWindow *self, BriskItem *item,
                                     BriskMenuEntryButton *button);
 void brisk_menu_window_configure_context(BriskMenuWindow *self);
+void brisk_menu_window_dispose_context(BriskMenuWindow *self);
+void brisk_menu_window_invalidate_context(BriskMenuWindow *self, const gchar *id);
+void brisk_menu_window_foreach_context(BriskMenuWindow *self, GtkCallback callback,
+                                       gpointer user_data);
 
 /* Search */
 void brisk_menu_window_clear_search(GtkEntry *entry, GtkEntryIconPosition pos, GdkEvent *event,
@@ -15,6 +15,7 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "menu-private.h"
+#include "trace.h"
 #include <gio/gdesktopappinfo.h>
 #include <gtk/gtk.h>
 #include <string.h>
@@ -66,9 +67,9 @@ static void brisk_menu_set_categories_sensitive(BriskMenuWindow *self, gboolean
 __brisk_pure__ static gboolean brisk_menu_window_filter_section(BriskMenuWindow *self,
                                                                 BriskItem *item)
 {
-        /* All visible */
+        /* All visible, except actions which only turn up when searching */
         if (!self->active_section) {
-                return TRUE;
+                return brisk_item_get_parent(item) == NULL;
         }
 
         return brisk_section_can_show_item(self->active_section, item);
@@ -98,10 +99,16 @@ void brisk_menu_window_search(BriskMenuWindow *self, GtkEntry *entry)
 {
         const gchar *search_term = NULL;
 
+        if (gtk_widget_get_mapped(GTK_WIDGET(self))) {
+                brisk_menu_window_latency_begin(self, BRISK_MENU_LATENCY_SEARCH);
+        }
+
         if (!self->filtering) {
                 return;
         }
 
+        brisk_trace_span("window.search");
+
         /* Remove old search term */
         search_term = gtk_entry_get_text(entry);
         g_clear_pointer(&self->search_term, g_free);
@@ -123,27 +130,15 @@ void brisk_menu_window_search(BriskMenuWindow *self, GtkEntry *entry)
 
 __brisk_pure__ gboolean brisk_menu_window_filter_apps(BriskMenuWindow *self, GtkWidget *child)
 {
-        const gchar *item_id = NULL;
         BriskItem *item = NULL;
-        GtkWidget *compare_child = NULL;
 
         g_object_get(child, "item", &item, NULL);
         if (!item) {
                 return FALSE;
         }
 
-        /* Item ID's are unique, so the last entry added for an ID is the
-         * button we want to display. Basically, a button can be duplicated and
-         * appear in multiple categories. By keeping a unique ID -> button mapping,
-         * we ensure we only ever show it once in the search function.
-         */
-        item_id = brisk_item_get_id(item);
-        if (item_id) {
-                compare_child = g_hash_table_lookup(self->item_store, item_id);
-                if (compare_child && compare_child != child) {
-                        return FALSE;
-                }
-        }
+        /* Backends emit each item exactly once, so there are no duplicate
+         * rows to hide here. */
 
         /* If we have no search term, filter on the section */
         if (!self->search_term) {
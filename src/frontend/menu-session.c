@@ -15,6 +15,7 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "menu-private.h"
+#include "trace.h"
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 BRISK_END_PEDANTIC
@@ -33,6 +34,8 @@ static void brisk_menu_window_logout_cb(__brisk_unused__ GObject *obj, GAsyncRes
 
 static gboolean brisk_menu_window_logout_real(BriskMenuWindow *self)
 {
+        brisk_trace_span("session.logout");
+
         if (!self->session) {
                 return FALSE;
         }
@@ -69,6 +72,8 @@ static void brisk_menu_window_shutdown_cb(__brisk_unused__ GObject *obj, GAsyncR
 
 static inline gboolean brisk_menu_window_shutdown_real(BriskMenuWindow *self)
 {
+        brisk_trace_span("session.shutdown");
+
         if (!self->session) {
                 return FALSE;
         }
@@ -102,6 +107,8 @@ static void brisk_menu_window_lock_cb(__brisk_unused__ GObject *obj, GAsyncResul
 
 static inline gboolean brisk_menu_window_lock_real(BriskMenuWindow *self)
 {
+        brisk_trace_span("session.lock");
+
         if (!self->saver) {
                 return FALSE;
         }
@@ -118,48 +125,163 @@ void brisk_menu_window_lock(BriskMenuWindow *self, __brisk_unused__ gpointer v)
         g_idle_add((GSourceFunc)brisk_menu_window_lock_real, self);
 }
 
-gboolean brisk_menu_window_setup_session(BriskMenuWindow *self)
+/**
+ * Let the implementation reflect what the session services told us
+ */
+static void brisk_menu_window_update_session(BriskMenuWindow *self)
+{
+        BriskMenuWindowClass *klazz = BRISK_MENU_WINDOW_GET_CLASS(self);
+
+        if (klazz->update_session) {
+                klazz->update_session(self);
+        }
+}
+
+/**
+ * Replies may arrive after the window has gone away, in which case our
+ * cancellable has been triggered and we must not touch self.
+ */
+static gboolean brisk_menu_window_session_cancelled(GError *error)
+{
+        return error && g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+}
+
+static void brisk_menu_window_session_done(BriskMenuWindow *self)
+{
+        --self->session_pending;
+        brisk_menu_window_update_session(self);
+}
+
+static void brisk_menu_window_can_shutdown_cb(GObject *obj, GAsyncResult *res, gpointer v)
 {
         autofree(GError) *error = NULL;
+        BriskMenuWindow *self = v;
         gboolean can_shutdown = FALSE;
-        __brisk_unused__ gboolean is_active = FALSE;
 
-        /* Sort out gnome-session dbus */
-        self->session = gnome_session_manager_proxy_new_for_bus_sync(
-            G_BUS_TYPE_SESSION,
-            G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START | G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
-            "org.gnome.SessionManager",
-            "/org/gnome/SessionManager",
-            NULL,
-            &error);
+        gnome_session_manager_call_can_shutdown_finish(GNOME_SESSION_MANAGER(obj),
+                                                       &can_shutdown,
+                                                       res,
+                                                       &error);
+        if (brisk_menu_window_session_cancelled(error)) {
+                return;
+        }
         if (error) {
-                g_warning("Failed to contact org.gnome.SessionManager: %s\n", error->message);
-                g_error_free(error);
+                g_warning("org.gnome.SessionManager not running: %s\n", error->message);
+        } else {
+                /* If it answers at all we can log out, shutdown is down to policy */
+                self->can_logout = TRUE;
+                self->can_shutdown = can_shutdown;
+        }
+        brisk_menu_window_session_done(self);
+}
+
+static void brisk_menu_window_session_proxy_cb(__brisk_unused__ GObject *obj, GAsyncResult *res,
+                                               gpointer v)
+{
+        autofree(GError) *error = NULL;
+        BriskMenuWindow *self = v;
+        GnomeSessionManager *session = NULL;
 
-                goto saver_init;
+        session = gnome_session_manager_proxy_new_for_bus_finish(res, &error);
+        if (brisk_menu_window_session_cancelled(error)) {
+                return;
         }
+        if (error) {
+                g_warning("Failed to contact org.gnome.SessionManager: %s\n", error->message);
+                brisk_menu_window_session_done(self);
+                return;
+        }
+
+        self->session = session;
 
         /* Set sensitive according to policy */
-        gnome_session_manager_call_can_shutdown_sync(self->session, &can_shutdown, NULL, NULL);
-
-saver_init:
-        self->saver =
-            mate_screen_saver_proxy_new_for_bus_sync(G_BUS_TYPE_SESSION,
-                                                     G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
-                                                     "org.mate.ScreenSaver",
-                                                     "/org/mate/ScreenSaver",
-                                                     NULL,
-                                                     &error);
+        gnome_session_manager_call_can_shutdown(self->session,
+                                                self->session_cancellable,
+                                                brisk_menu_window_can_shutdown_cb,
+                                                self);
+}
+
+static void brisk_menu_window_get_active_cb(GObject *obj, GAsyncResult *res, gpointer v)
+{
+        autofree(GError) *error = NULL;
+        BriskMenuWindow *self = v;
+        __brisk_unused__ gboolean is_active = FALSE;
+
+        mate_screen_saver_call_get_active_finish(MATE_SCREEN_SAVER(obj), &is_active, res, &error);
+        if (brisk_menu_window_session_cancelled(error)) {
+                return;
+        }
+        if (error) {
+                g_warning("org.mate.ScreenSaver not running: %s\n", error->message);
+        } else {
+                self->can_lock = TRUE;
+        }
+        brisk_menu_window_session_done(self);
+}
+
+static void brisk_menu_window_saver_proxy_cb(__brisk_unused__ GObject *obj, GAsyncResult *res,
+                                             gpointer v)
+{
+        autofree(GError) *error = NULL;
+        BriskMenuWindow *self = v;
+        MateScreenSaver *saver = NULL;
+
+        saver = mate_screen_saver_proxy_new_for_bus_finish(res, &error);
+        if (brisk_menu_window_session_cancelled(error)) {
+                return;
+        }
         if (error) {
                 g_warning("Failed to contact org.mate.ScreenSaver: %s\n", error->message);
-                return FALSE;
+                brisk_menu_window_session_done(self);
+                return;
         }
 
+        self->saver = saver;
+
         /* Check the screensaver is *really* running */
-        mate_screen_saver_call_get_active_sync(self->saver, &is_active, NULL, &error);
-        if (error) {
-                g_warning("org.mate.ScreenSaver not running: %s\n", error->message);
+        mate_screen_saver_call_get_active(self->saver,
+                                          self->session_cancellable,
+                                          brisk_menu_window_get_active_cb,
+                                          self);
+}
+
+/**
+ * brisk_menu_window_setup_session:
+ *
+ * Begin contacting the session manager and screensaver. Nothing here
+ * blocks, as either service may be slow or missing entirely at login, so
+ * the session controls are updated as each reply comes in.
+ */
+gboolean brisk_menu_window_setup_session(BriskMenuWindow *self)
+{
+        brisk_trace_span("session.setup");
+
+        if (self->session_cancellable) {
+                return FALSE;
         }
+
+        self->session_cancellable = g_cancellable_new();
+        self->session_pending = 2;
+
+        /* Sort out gnome-session dbus */
+        gnome_session_manager_proxy_new_for_bus(G_BUS_TYPE_SESSION,
+                                                G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START |
+                                                    G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                                "org.gnome.SessionManager",
+                                                "/org/gnome/SessionManager",
+                                                self->session_cancellable,
+                                                brisk_menu_window_session_proxy_cb,
+                                                self);
+
+        mate_screen_saver_proxy_new_for_bus(G_BUS_TYPE_SESSION,
+                                            G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                            "org.mate.ScreenSaver",
+                                            "/org/mate/ScreenSaver",
+                                            self->session_cancellable,
+                                            brisk_menu_window_saver_proxy_cb,
+                                            self);
+
+        brisk_menu_window_update_session(self);
         return FALSE;
 }
 
@@ -45,6 +45,8 @@ void brisk_menu_window_pump_settings(BriskMenuWindow *self)
 {
         brisk_menu_window_settings_changed(self->settings, "search-position", self);
         brisk_menu_window_settings_changed(self->settings, "rollover-activate", self);
+        brisk_menu_window_settings_changed(self->settings, "prefetch-apps", self);
+        brisk_menu_window_settings_changed(self->settings, "hot-key-raw", self);
         brisk_menu_window_settings_changed(self->settings, "hot-key", self);
 }
 
@@ -59,6 +61,10 @@ static void brisk_menu_window_settings_changed(GSettings *settings, const gchar
                 return;
         } else if (g_str_equal(key, "rollover-activate")) {
                 self->rollover = g_settings_get_boolean(settings, key);
+        } else if (g_str_equal(key, "prefetch-apps")) {
+                self->prefetch = g_settings_get_boolean(settings, key);
+        } else if (g_str_equal(key, "hot-key-raw")) {
+                brisk_menu_window_update_hotkey_mode(self, g_settings_get_boolean(settings, key));
         } else if (g_str_equal(key, "hot-key")) {
                 value = g_settings_get_string(settings, key);
                 brisk_menu_window_update_hotkey(self, value);
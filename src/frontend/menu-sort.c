@@ -45,26 +45,32 @@ __brisk_pure__ static gint brisk_get_entry_score(BriskItem *item, const gchar *t
         return score;
 }
 
-__brisk_pure__ gint brisk_menu_window_sort(BriskMenuWindow *self, BriskItem *itemA,
-                                           BriskItem *itemB)
+/**
+ * brisk_menu_sort_items:
+ *
+ * Compare two items for display, either by their score against the search
+ * term, the order imposed by the section, or finally by name.
+ */
+__brisk_pure__ gint brisk_menu_sort_items(BriskItem *itemA, BriskItem *itemB,
+                                          const gchar *search_term, BriskSection *section)
 {
         autofree(gchar) *nameA = NULL;
         autofree(gchar) *nameB = NULL;
         gint sc1 = -1, sc2 = -1;
 
         /* Handle normal searching */
-        if (self->search_term) {
-                sc1 = brisk_get_entry_score(itemA, self->search_term);
-                sc2 = brisk_get_entry_score(itemB, self->search_term);
+        if (search_term) {
+                sc1 = brisk_get_entry_score(itemA, search_term);
+                sc2 = brisk_get_entry_score(itemB, search_term);
                 return (sc1 > sc2) - (sc1 - sc2);
         }
 
-        if (!self->active_section) {
+        if (!section) {
                 goto basic_sort;
         }
 
-        sc1 = brisk_section_get_sort_order(self->active_section, itemB);
-        sc2 = brisk_section_get_sort_order(self->active_section, itemA);
+        sc1 = brisk_section_get_sort_order(section, itemB);
+        sc2 = brisk_section_get_sort_order(section, itemA);
 
         /* Negative score means the section doesn't support custom ordering */
         if (sc1 >= 0 || sc2 >= 0) {
@@ -80,6 +86,81 @@ basic_sort:
         return g_strcmp0(nameA, nameB);
 }
 
+/**
+ * brisk_menu_window_sort:
+ *
+ * Compare two rows for display. Custom section orders are cached on the
+ * buttons themselves, so the hot path never has to ask the section.
+ */
+__brisk_pure__ gint brisk_menu_window_sort(BriskMenuWindow *self, BriskMenuEntryButton *buttonA,
+                                           BriskMenuEntryButton *buttonB)
+{
+        gint orderA = buttonA->sort_order;
+        gint orderB = buttonB->sort_order;
+
+        if (!self->search_term && (orderA >= 0 || orderB >= 0)) {
+                /* Anything the section doesn't order goes last */
+                if (orderA < 0) {
+                        return 1;
+                } else if (orderB < 0) {
+                        return -1;
+                }
+                return (orderA > orderB) - (orderA < orderB);
+        }
+
+        return brisk_menu_sort_items(buttonA->item, buttonB->item, self->search_term, NULL);
+}
+
+/**
+ * brisk_menu_window_update_sort_order:
+ *
+ * Cache the button's position within the active section's own order.
+ * Searches ignore it, so it doesn't need refreshing when the term changes.
+ */
+void brisk_menu_window_update_sort_order(BriskMenuWindow *self, BriskMenuEntryButton *button)
+{
+        if (!self->active_section) {
+                button->sort_order = -1;
+                return;
+        }
+        button->sort_order = brisk_section_get_sort_order(self->active_section, button->item);
+}
+
+/**
+ * brisk_menu_window_update_sort_orders:
+ *
+ * Refresh every cached position, as the section or its order has changed
+ */
+void brisk_menu_window_update_sort_orders(BriskMenuWindow *self)
+{
+        GHashTableIter iter;
+        gpointer value = NULL;
+
+        g_hash_table_iter_init(&iter, self->item_store);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                if (BRISK_IS_MENU_ENTRY_BUTTON(value)) {
+                        brisk_menu_window_update_sort_order(self, value);
+                }
+        }
+}
+
+/**
+ * brisk_menu_window_item_dropped:
+ *
+ * An item was dragged onto another in a section with its own order, so
+ * move it to the target's place. The section's backend tells us which
+ * rows changed once it has.
+ */
+void brisk_menu_window_item_dropped(BriskMenuWindow *self, BriskItem *item,
+                                    BriskMenuEntryButton *target)
+{
+        if (self->search_term || !self->active_section || target->sort_order < 0) {
+                return;
+        }
+
+        brisk_section_set_sort_order(self->active_section, item, target->sort_order);
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
@@ -15,6 +15,7 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "menu-private.h"
+#include "trace.h"
 BRISK_END_PEDANTIC
 
 G_DEFINE_TYPE(BriskMenuWindow, brisk_menu_window, GTK_TYPE_WINDOW)
@@ -42,14 +43,19 @@ static void brisk_menu_window_dispose(GObject *obj)
         g_clear_pointer(&self->shortcut, g_free);
         g_clear_pointer(&self->search_term, g_free);
         g_clear_object(&self->launcher);
+        if (self->session_cancellable) {
+                g_cancellable_cancel(self->session_cancellable);
+                g_clear_object(&self->session_cancellable);
+        }
         g_clear_object(&self->session);
         g_clear_object(&self->saver);
         g_clear_object(&self->settings);
         g_clear_pointer(&self->item_store, g_hash_table_unref);
+        g_clear_pointer(&self->loading, g_hash_table_unref);
         g_clear_pointer(&self->section_boxes, g_hash_table_unref);
         g_clear_pointer(&self->backends, g_hash_table_unref);
-        g_clear_pointer(&self->context_menu, gtk_widget_destroy);
-        g_clear_object(&self->context_group);
+        brisk_menu_window_dispose_context(self);
+        brisk_menu_window_dispose_prefetch(self);
 
         G_OBJECT_CLASS(brisk_menu_window_parent_class)->dispose(obj);
 }
@@ -89,15 +95,20 @@ static void brisk_menu_window_init(BriskMenuWindow *self)
         gtk_window_set_skip_pager_hint(GTK_WINDOW(self), TRUE);
         gtk_window_set_skip_taskbar_hint(GTK_WINDOW(self), TRUE);
 
-        /* Initialise main tables */
-        self->item_store = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
-        self->section_boxes = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, NULL);
-        self->backends = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, g_object_unref);
+        /* Initialise main tables. All IDs are interned by the backends, so we
+         * only need to hash and compare the pointers */
+        self->item_store = g_hash_table_new(g_direct_hash, g_direct_equal);
+        self->loading = g_hash_table_new(g_direct_hash, g_direct_equal);
+        self->section_boxes = g_hash_table_new(g_direct_hash, g_direct_equal);
+        self->backends = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_object_unref);
 
         self->binder = brisk_key_binder_new();
         self->launcher = brisk_menu_launcher_new();
 
         brisk_menu_window_init_settings(self);
+        brisk_menu_window_configure_latency(self);
+        brisk_menu_window_configure_context(self);
+        brisk_menu_window_configure_prefetch(self);
 }
 
 static void brisk_menu_window_set_property(GObject *object, guint id, const GValue *value,
@@ -213,6 +224,7 @@ void brisk_menu_window_update_screen_position(BriskMenuWindow *window)
         g_assert(window != NULL);
         BriskMenuWindowClass *klazz = BRISK_MENU_WINDOW_GET_CLASS(window);
         g_assert(klazz->add_item != NULL);
+        brisk_trace_span("window.update-screen-position");
         klazz->update_screen_position(window);
 }
 
@@ -229,8 +241,21 @@ void brisk_menu_window_add_item(BriskMenuWindow *window, BriskItem *item, BriskB
 {
         g_assert(window != NULL);
         BriskMenuWindowClass *klazz = BRISK_MENU_WINDOW_GET_CLASS(window);
+        const gchar *id = brisk_item_get_id(item);
+        gboolean known = FALSE;
+        GtkWidget *button = NULL;
+
         g_assert(klazz->add_item != NULL);
+        brisk_trace_span("window.add-item");
+
+        known = g_hash_table_contains(window->item_store, id);
         klazz->add_item(window, item, backend);
+
+        /* Only watch buttons that are new, not items we already had */
+        button = g_hash_table_lookup(window->item_store, id);
+        if (!known && button) {
+                brisk_menu_window_prefetch_button(window, button);
+        }
 }
 
 void brisk_menu_window_add_section(BriskMenuWindow *window, BriskSection *section,
@@ -250,11 +275,41 @@ void brisk_menu_window_invalidate_filter(BriskMenuWindow *window, BriskBackend *
         klazz->invalidate_filter(window, backend);
 }
 
+/**
+ * brisk_menu_window_invalidate_item:
+ *
+ * Refilter and resort only the row for the given item ID, if we have one
+ */
+void brisk_menu_window_invalidate_item(BriskMenuWindow *window, const gchar *id)
+{
+        g_assert(window != NULL);
+        BriskMenuWindowClass *klazz = BRISK_MENU_WINDOW_GET_CLASS(window);
+        GtkWidget *button = NULL;
+
+        button = g_hash_table_lookup(window->item_store, g_intern_string(id));
+        if (!button) {
+                return;
+        }
+
+        /* Backends report every row whose position changed, one at a time */
+        if (BRISK_IS_MENU_ENTRY_BUTTON(button)) {
+                brisk_menu_window_update_sort_order(window, BRISK_MENU_ENTRY_BUTTON(button));
+        }
+
+        /* Windows that can't do a single row fall back to everything */
+        if (!klazz->invalidate_item) {
+                brisk_menu_window_invalidate_filter(window, NULL);
+                return;
+        }
+        klazz->invalidate_item(window, button);
+}
+
 void brisk_menu_window_reset(BriskMenuWindow *window, BriskBackend *backend)
 {
         g_assert(window != NULL);
         BriskMenuWindowClass *klazz = BRISK_MENU_WINDOW_GET_CLASS(window);
         g_assert(klazz->reset != NULL);
+        brisk_menu_window_invalidate_context(window, NULL);
         klazz->reset(window, backend);
 }
 
@@ -29,6 +29,16 @@ typedef struct _BriskMenuWindowClass BriskMenuWindowClass;
 #define BRISK_MENU_WINDOW_GET_CLASS(o)                                                             \
         (G_TYPE_INSTANCE_GET_CLASS((o), BRISK_TYPE_MENU_WINDOW, BriskMenuWindowClass))
 
+/**
+ * Latencies measured from user input until the result is visible
+ */
+typedef enum {
+        BRISK_MENU_LATENCY_OPEN = 0, /**<Button or hotkey press until the menu is painted */
+        BRISK_MENU_LATENCY_SEARCH,   /**<Search keystroke until the results are painted */
+        BRISK_MENU_LATENCY_LAUNCH,   /**<Activating an item until its process is spawned */
+        BRISK_MENU_LATENCY_N,
+} BriskMenuLatency;
+
 GType brisk_menu_window_get_type(void);
 
 const gchar *brisk_menu_window_get_id(BriskMenuWindow *window);
@@ -36,10 +46,16 @@ const gchar *brisk_menu_window_get_display_name(BriskMenuWindow *window);
 void brisk_menu_window_update_screen_position(BriskMenuWindow *window);
 void brisk_menu_window_update_search(BriskMenuWindow *window);
 void brisk_menu_window_invalidate_filter(BriskMenuWindow *self, BriskBackend *backend);
+void brisk_menu_window_invalidate_item(BriskMenuWindow *self, const gchar *id);
 void brisk_menu_window_add_item(BriskMenuWindow *window, BriskItem *item, BriskBackend *backend);
 void brisk_menu_window_add_section(BriskMenuWindow *window, BriskSection *section,
                                    BriskBackend *backend);
 void brisk_menu_window_reset(BriskMenuWindow *window, BriskBackend *backend);
+void brisk_menu_window_latency_init(void);
+void brisk_menu_window_latency_begin(BriskMenuWindow *window, BriskMenuLatency kind);
+void brisk_menu_window_latency_record(BriskMenuLatency kind, gint64 value);
+void brisk_menu_window_latency_failed(BriskMenuLatency kind);
+void brisk_menu_window_dump_latency(void);
 
 G_END_DECLS
 
@@ -19,39 +19,65 @@ BRISK_BEGIN_PEDANTIC
 #include "key-binder.h"
 #include <X11/XKBlib.h>
 #include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#if defined(BRISK_ENABLE_XI2)
+#include <X11/extensions/XInput2.h>
+#endif
 #include <gdk/gdk.h>
 #include <gdk/gdkx.h>
 #include <gtk/gtk.h>
+#include <limits.h>
 BRISK_END_PEDANTIC
 
 struct _BriskKeyBinderClass {
         GObjectClass parent_class;
 };
 
-/**
- * BriskKeyBinder is used to bind global x11 shortcuts
- */
-struct _BriskKeyBinder {
-        GObject parent;
-        GdkWindow *root_window;
-        GHashTable *bindings;
-        gboolean wait_for_release;
-};
-
 /**
  * A KeyBinding is used to map the input + function pointer into something
  * we can store and test.
  */
 typedef struct KeyBinding {
         const gchar *accelerator;
+        guint keysym;
         KeyCode keycode;
         GdkModifierType mods;
         BinderFunc func;
         gpointer udata;
+        gboolean raw;            /**<Watched through XI2 raw events, not grabbed */
+        struct KeyBinding *next; /**<Next binding sharing our keycode */
 } KeyBinding;
 
+/**
+ * BriskKeyBinder is used to bind global x11 shortcuts
+ */
+struct _BriskKeyBinder {
+        GObject parent;
+        GdkWindow *root_window;
+        GHashTable *bindings;                    /**<Owns each KeyBinding, by accelerator */
+        KeyBinding *keycodes[UCHAR_MAX + 1];     /**<Bindings indexed by keycode */
+        const KeyBinding *pending;               /**<Pressed, waiting on its release */
+        BriskKeyBinderMode mode;                 /**<How bare modifiers are detected */
+        int xi_opcode;                           /**<XInputExtension, for raw events */
+        KeyBinding *raw_keycodes[UCHAR_MAX + 1]; /**<Raw bindings indexed by keycode */
+        const KeyBinding *raw_pending;           /**<Modifier pressed on its own */
+        guint raw_held;                          /**<Keys currently held down */
+};
+
+#if defined(BRISK_ENABLE_XI2)
+/**
+ * XI2 event selections belong to the X client rather than to us, so they're
+ * shared between every binder in the process
+ */
+static guint raw_listeners = 0;
+#endif
+
 static GdkFilterReturn brisk_key_binder_filter(GdkXEvent *xevent, GdkEvent *event, gpointer v);
-static void free_keybinding(KeyBinding *binding);
+static GdkFilterReturn brisk_key_binder_raw_filter(GdkXEvent *xevent, GdkEvent *event,
+                                                   gpointer v);
+static void brisk_key_binder_attach(BriskKeyBinder *self, KeyBinding *binding);
+static void brisk_key_binder_detach(BriskKeyBinder *self, KeyBinding *binding);
+static void brisk_key_binder_select_raw(BriskKeyBinder *self, gboolean enable);
 
 /**
  * When binding a shortcut, we bind all possible combinations of lock key modifiers
@@ -86,10 +112,26 @@ BriskKeyBinder *brisk_key_binder_new()
 static void brisk_key_binder_dispose(GObject *obj)
 {
         BriskKeyBinder *self = NULL;
+        GHashTableIter iter = { 0 };
+        gpointer value = NULL;
 
-        /* Remove our filter again */
         self = BRISK_KEY_BINDER(obj);
+
+        /* Release every grab while we still have the root window */
+        if (self->bindings) {
+                g_hash_table_iter_init(&iter, self->bindings);
+                while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                        brisk_key_binder_detach(self, value);
+                }
+        }
+
+        /* Remove our filters again */
         if (self->root_window) {
+                if (self->mode == BRISK_KEY_BINDER_MODE_RAW) {
+                        gdk_window_remove_filter(NULL, brisk_key_binder_raw_filter, self);
+                        brisk_key_binder_select_raw(self, FALSE);
+                        self->mode = BRISK_KEY_BINDER_MODE_GRAB;
+                }
                 gdk_window_remove_filter(self->root_window, brisk_key_binder_filter, self);
                 self->root_window = NULL;
         }
@@ -122,8 +164,8 @@ static void brisk_key_binder_init(BriskKeyBinder *self)
 {
         GdkWindow *root = NULL;
 
-        self->bindings =
-            g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)free_keybinding);
+        self->bindings = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+        self->mode = BRISK_KEY_BINDER_MODE_GRAB;
 
         root = gdk_get_default_root_window();
         if (!root) {
@@ -134,6 +176,22 @@ static void brisk_key_binder_init(BriskKeyBinder *self)
         gdk_window_add_filter(root, brisk_key_binder_filter, self);
 }
 
+/**
+ * Find the binding for a key press, only ever looking at the bindings for
+ * this one keycode
+ */
+static const KeyBinding *brisk_key_binder_lookup(BriskKeyBinder *self, KeyCode keycode,
+                                                 guint mods)
+{
+        for (const KeyBinding *binding = self->keycodes[keycode]; binding;
+             binding = binding->next) {
+                if (binding->mods == mods) {
+                        return binding;
+                }
+        }
+        return NULL;
+}
+
 /**
  * Handle global events (eventually)
  */
@@ -141,11 +199,10 @@ static GdkFilterReturn brisk_key_binder_filter(GdkXEvent *xevent, GdkEvent *even
 {
         BriskKeyBinder *self = NULL;
         XEvent *xev = xevent;
-        GHashTableIter iter = { 0 };
-        const gchar *key = NULL;
         const KeyBinding *binding = NULL;
         guint mods;
         Display *display = NULL;
+        KeyCode keycode;
         KeySym keysym;
 
         self = BRISK_KEY_BINDER(v);
@@ -155,47 +212,314 @@ static GdkFilterReturn brisk_key_binder_filter(GdkXEvent *xevent, GdkEvent *even
                 return GDK_FILTER_CONTINUE;
         }
 
+        /* Never act on events we (or anyone else) re-sent */
+        if (xev->xkey.send_event) {
+                return GDK_FILTER_CONTINUE;
+        }
+
+        keycode = (KeyCode)xev->xkey.keycode;
+
         /* unset mask of the lock keys */
         mods = xev->xkey.state & ~(_modifiers[7]);
 
         /* unset mask of Mod4 if using Super_L key as hotkey */
-        keysym = XkbKeycodeToKeysym(display, (KeyCode)xev->xkey.keycode, 0, 0);
+        keysym = XkbKeycodeToKeysym(display, keycode, 0, 0);
         if (keysym == GDK_KEY_Super_L) {
                 mods = mods & ~((guint)GDK_MOD4_MASK);
         }
 
-        g_hash_table_iter_init(&iter, self->bindings);
+        if (xev->type == KeyPress && !self->pending) {
+                /* capture initial key press */
+                self->pending = brisk_key_binder_lookup(self, keycode, mods);
+                if (self->pending) {
+                        return GDK_FILTER_CONTINUE;
+                }
+        } else if (xev->type == KeyRelease && self->pending &&
+                   self->pending->keycode == keycode) {
+                /* capture release within same shortcut sequence */
+                binding = self->pending;
+                self->pending = NULL;
+                binding->func(event, binding->udata);
+                return GDK_FILTER_CONTINUE;
+        }
+
+        /* when breaking the shortcut sequence, send the event up the window
+         * hierarchy in case it's part of a different shortcut sequence
+         * (e.g. <Mod4>a). This happens once per event no matter how many
+         * bindings we hold. */
+        self->pending = NULL;
+        XUngrabKeyboard(display, xev->xkey.time);
+        XSendEvent(display, xev->xkey.window, TRUE, KeyPressMask | KeyReleaseMask, xev);
+
+        return GDK_FILTER_CONTINUE;
+}
 
-        /* Find a matching binding */
-        while (g_hash_table_iter_next(&iter, (void **)&key, (void **)&binding)) {
-                if (xev->type == KeyPress && xev->xkey.keycode == binding->keycode &&
-                    !self->wait_for_release) {
-                        /* capture initial key press */
-                        if (mods == binding->mods) {
-                                self->wait_for_release = TRUE;
-                        }
-                } else if (xev->type == KeyRelease && xev->xkey.keycode == binding->keycode &&
-                           self->wait_for_release) {
-                        /* capture release within same shortcut sequence */
+#if defined(BRISK_ENABLE_XI2)
+
+/**
+ * Raw events arrive no matter who holds a grab, and without us grabbing
+ * anything. We can't swallow them, so only bare modifiers are watched this
+ * way: a tap of one is the press and release with nothing else in between.
+ */
+static GdkFilterReturn brisk_key_binder_raw_filter(GdkXEvent *xevent, GdkEvent *event,
+                                                   gpointer v)
+{
+        BriskKeyBinder *self = BRISK_KEY_BINDER(v);
+        XGenericEventCookie *cookie = &((XEvent *)xevent)->xcookie;
+        const XIRawEvent *raw = NULL;
+        const KeyBinding *binding = NULL;
+
+        if (cookie->type != GenericEvent || cookie->extension != self->xi_opcode ||
+            !cookie->data) {
+                return GDK_FILTER_CONTINUE;
+        }
+        raw = cookie->data;
+
+        switch (cookie->evtype) {
+        case XI_RawKeyPress:
+                if (raw->flags & XIKeyRepeat) {
+                        break;
+                }
+                /* Only a modifier pressed on its own starts a tap, and any
+                 * other key pressed since breaks it */
+                self->raw_pending = NULL;
+                if (self->raw_held == 0 && raw->detail >= 0 && raw->detail <= UCHAR_MAX) {
+                        self->raw_pending = self->raw_keycodes[raw->detail];
+                }
+                ++self->raw_held;
+                break;
+        case XI_RawKeyRelease:
+                if (self->raw_held > 0) {
+                        --self->raw_held;
+                }
+                if (self->raw_pending && self->raw_pending->keycode == raw->detail) {
+                        binding = self->raw_pending;
+                        self->raw_pending = NULL;
                         binding->func(event, binding->udata);
-                        self->wait_for_release = FALSE;
-                } else {
-                        XUngrabKeyboard(display, xev->xkey.time);
-                        /* when breaking the shortcut sequence, send the event up the window
-                         * hierarchy in case it's part of a different shortcut sequence
-                         * (e.g. <Mod4>a) */
-                        XSendEvent(display,
-                                   xev->xkey.window,
-                                   TRUE,
-                                   KeyPressMask | KeyReleaseMask,
-                                   xev);
-                        self->wait_for_release = FALSE;
                 }
+                break;
+        case XI_RawButtonPress:
+                /* e.g. <Super>+drag to move a window */
+                self->raw_pending = NULL;
+                break;
+        default:
+                break;
         }
 
         return GDK_FILTER_CONTINUE;
 }
 
+/**
+ * Ask for raw key and button events on the root window, or stop again once
+ * the last binder in raw mode is done with them
+ */
+static void brisk_key_binder_select_raw(BriskKeyBinder *self, gboolean enable)
+{
+        unsigned char bits[XIMaskLen(XI_LASTEVENT)] = { 0 };
+        XIEventMask mask = { 0 };
+
+        if (enable && raw_listeners++ > 0) {
+                return;
+        } else if (!enable && --raw_listeners > 0) {
+                return;
+        }
+
+        if (enable) {
+                XISetMask(bits, XI_RawKeyPress);
+                XISetMask(bits, XI_RawKeyRelease);
+                XISetMask(bits, XI_RawButtonPress);
+        }
+
+        /* Master devices only, otherwise we'd see each key twice */
+        mask.deviceid = XIAllMasterDevices;
+        mask.mask_len = sizeof(bits);
+        mask.mask = bits;
+
+        XISelectEvents(GDK_WINDOW_XDISPLAY(self->root_window),
+                       GDK_WINDOW_XID(self->root_window),
+                       &mask,
+                       1);
+        gdk_flush();
+}
+
+/**
+ * GDK has already negotiated XI2 with the server if it's usable, we only
+ * need the extension opcode to recognise the events
+ */
+static gboolean brisk_key_binder_init_raw(BriskKeyBinder *self)
+{
+        GdkDisplay *display = NULL;
+        int event = 0;
+        int error = 0;
+
+        if (!self->root_window) {
+                return FALSE;
+        }
+
+        display = gdk_window_get_display(self->root_window);
+        if (!GDK_IS_X11_DEVICE_MANAGER_XI2(gdk_display_get_device_manager(display))) {
+                return FALSE;
+        }
+
+        return XQueryExtension(GDK_DISPLAY_XDISPLAY(display),
+                               "XInputExtension",
+                               &self->xi_opcode,
+                               &event,
+                               &error);
+}
+
+#else
+
+/**
+ * Built without libXi, so raw mode is never available and these are only
+ * here to keep the callers simple
+ */
+static GdkFilterReturn brisk_key_binder_raw_filter(__brisk_unused__ GdkXEvent *xevent,
+                                                   __brisk_unused__ GdkEvent *event,
+                                                   __brisk_unused__ gpointer v)
+{
+        return GDK_FILTER_CONTINUE;
+}
+
+static void brisk_key_binder_select_raw(__brisk_unused__ BriskKeyBinder *self,
+                                        __brisk_unused__ gboolean enable)
+{
+}
+
+static gboolean brisk_key_binder_init_raw(__brisk_unused__ BriskKeyBinder *self)
+{
+        return FALSE;
+}
+
+#endif
+
+/**
+ * Bare modifiers are only left ungrabbed in raw mode
+ */
+static gboolean brisk_key_binder_wants_raw(BriskKeyBinder *self, KeyBinding *binding)
+{
+        return self->mode == BRISK_KEY_BINDER_MODE_RAW && binding->mods == 0 &&
+               IsModifierKey(binding->keysym);
+}
+
+/**
+ * Index the binding, and grab it unless we're watching it through XI2
+ */
+static void brisk_key_binder_attach(BriskKeyBinder *self, KeyBinding *binding)
+{
+        KeyBinding **table = NULL;
+        Display *display = GDK_WINDOW_XDISPLAY(self->root_window);
+        Window id = GDK_WINDOW_XID(self->root_window);
+
+        binding->raw = brisk_key_binder_wants_raw(self, binding);
+        table = binding->raw ? self->raw_keycodes : self->keycodes;
+        binding->next = table[binding->keycode];
+        table[binding->keycode] = binding;
+
+        if (binding->raw) {
+                return;
+        }
+
+        gdk_error_trap_push();
+        for (size_t i = 0; i < G_N_ELEMENTS(_modifiers); i++) {
+                GdkModifierType m = _modifiers[i];
+                XGrabKey(display,
+                         binding->keycode,
+                         binding->mods | m,
+                         id,
+                         TRUE,
+                         GrabModeAsync,
+                         GrabModeAsync);
+        }
+        gdk_flush();
+        gdk_error_trap_pop_ignored();
+}
+
+/**
+ * Take the binding back out of the index and drop its grabs
+ */
+static void brisk_key_binder_detach(BriskKeyBinder *self, KeyBinding *binding)
+{
+        KeyBinding **table = binding->raw ? self->raw_keycodes : self->keycodes;
+        Display *display = NULL;
+        Window id;
+
+        for (KeyBinding **link = &table[binding->keycode]; *link; link = &(*link)->next) {
+                if (*link == binding) {
+                        *link = binding->next;
+                        break;
+                }
+        }
+        binding->next = NULL;
+
+        if (self->pending == binding) {
+                self->pending = NULL;
+        }
+        if (self->raw_pending == binding) {
+                self->raw_pending = NULL;
+        }
+
+        if (binding->raw || !self->root_window) {
+                return;
+        }
+
+        display = GDK_WINDOW_XDISPLAY(self->root_window);
+        id = GDK_WINDOW_XID(self->root_window);
+
+        gdk_error_trap_push();
+        for (size_t i = 0; i < G_N_ELEMENTS(_modifiers); i++) {
+                XUngrabKey(display, binding->keycode, binding->mods | _modifiers[i], id);
+        }
+        gdk_flush();
+        gdk_error_trap_pop_ignored();
+}
+
+/**
+ * brisk_key_binder_set_mode:
+ *
+ * Switch how bare modifier shortcuts such as Super_L are detected, moving
+ * any existing bindings across. Raw mode needs XInput2, if it's missing
+ * or we were built without libXi we stay with grabs and return FALSE.
+ */
+gboolean brisk_key_binder_set_mode(BriskKeyBinder *self, BriskKeyBinderMode mode)
+{
+        GHashTableIter iter = { 0 };
+        gpointer value = NULL;
+
+        if (mode == self->mode) {
+                return TRUE;
+        }
+        if (mode == BRISK_KEY_BINDER_MODE_RAW && !brisk_key_binder_init_raw(self)) {
+                return FALSE;
+        }
+
+        g_hash_table_iter_init(&iter, self->bindings);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                brisk_key_binder_detach(self, value);
+        }
+
+        if (self->mode == BRISK_KEY_BINDER_MODE_RAW) {
+                gdk_window_remove_filter(NULL, brisk_key_binder_raw_filter, self);
+                brisk_key_binder_select_raw(self, FALSE);
+        }
+
+        self->mode = mode;
+        self->raw_held = 0;
+
+        if (self->mode == BRISK_KEY_BINDER_MODE_RAW) {
+                /* Raw events have no window, so only global filters see them */
+                gdk_window_add_filter(NULL, brisk_key_binder_raw_filter, self);
+                brisk_key_binder_select_raw(self, TRUE);
+        }
+
+        g_hash_table_iter_init(&iter, self->bindings);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                brisk_key_binder_attach(self, value);
+        }
+
+        return TRUE;
+}
+
 /**
  * Bind a shortcut with the appropriate callback
  */
@@ -205,7 +529,6 @@ gboolean brisk_key_binder_bind(BriskKeyBinder *self, const gchar *shortcut, Bind
         guint keysym;
         GdkModifierType mod;
         Display *display = NULL;
-        Window id;
         KeyCode key;
         KeyBinding *bind = NULL;
 
@@ -215,7 +538,6 @@ gboolean brisk_key_binder_bind(BriskKeyBinder *self, const gchar *shortcut, Bind
 
         gtk_accelerator_parse(shortcut, &keysym, &mod);
         display = GDK_WINDOW_XDISPLAY(self->root_window);
-        id = GDK_WINDOW_XID(self->root_window);
 
         key = XKeysymToKeycode(display, keysym);
         if (key == 0) {
@@ -224,50 +546,47 @@ gboolean brisk_key_binder_bind(BriskKeyBinder *self, const gchar *shortcut, Bind
 
         bind = g_new0(KeyBinding, 1);
         *bind = (KeyBinding){ .accelerator = shortcut,
+                              .keysym = keysym,
                               .keycode = key,
                               .mods = mod,
                               .func = func,
                               .udata = v };
 
         g_hash_table_insert(self->bindings, g_strdup(shortcut), bind);
-
-        gdk_error_trap_push();
-        for (size_t i = 0; i < G_N_ELEMENTS(_modifiers); i++) {
-                GdkModifierType m = _modifiers[i];
-                XGrabKey(display, key, mod | m, id, TRUE, GrabModeAsync, GrabModeAsync);
-        }
-        gdk_flush();
+        brisk_key_binder_attach(self, bind);
 
         return TRUE;
 }
 
 /**
- * Unbind the shortcut once again, if previously registered
+ * brisk_key_binder_is_raw:
+ *
+ * Whether the shortcut is watched through XI2 raw events rather than
+ * grabbed, in which case its taps arrive even while someone else holds
+ * the keyboard
  */
-gboolean brisk_key_binder_unbind(BriskKeyBinder *self, const gchar *shortcut)
+gboolean brisk_key_binder_is_raw(BriskKeyBinder *self, const gchar *shortcut)
 {
-        return g_hash_table_remove(self->bindings, shortcut);
+        KeyBinding *binding = g_hash_table_lookup(self->bindings, shortcut);
+
+        return binding && binding->raw;
 }
 
 /**
- * Handle cleaning up of the keybinding
+ * Unbind the shortcut once again, if previously registered
  */
-static void free_keybinding(KeyBinding *binding)
+gboolean brisk_key_binder_unbind(BriskKeyBinder *self, const gchar *shortcut)
 {
-        Display *display = NULL;
-        Window id;
-        GdkWindow *window = NULL;
-
-        window = gdk_get_default_root_window();
-        if (window) {
-                display = GDK_WINDOW_XDISPLAY(window);
-                id = GDK_WINDOW_XID(window);
-                XUngrabKey(display, binding->keycode, binding->mods, id);
-        } else {
-                g_warning("Could not find root window to XUngrabKey");
+        KeyBinding *binding = g_hash_table_lookup(self->bindings, shortcut);
+
+        if (!binding) {
+                return FALSE;
         }
 
-        g_free(binding);
+        /* Unlink from the keycode index before the table frees it */
+        brisk_key_binder_detach(self, binding);
+
+        return g_hash_table_remove(self->bindings, shortcut);
 }
 
 /*
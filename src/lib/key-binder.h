@@ -35,6 +35,14 @@ BriskKeyBinder *brisk_key_binder_new(void);
 
 GType brisk_key_binder_get_type(void);
 
+/**
+ * How bare modifier shortcuts, such as Super_L, are detected
+ */
+typedef enum {
+        BRISK_KEY_BINDER_MODE_GRAB = 0, /**<Passive grabs and a root window filter */
+        BRISK_KEY_BINDER_MODE_RAW,      /**<XInput2 raw events, without grabbing */
+} BriskKeyBinderMode;
+
 /**
  * A callback for the binder functions
  */
@@ -43,6 +51,8 @@ typedef void (*BinderFunc)(GdkEvent *event, gpointer v);
 gboolean brisk_key_binder_bind(BriskKeyBinder *self, const gchar *shortcut, BinderFunc func,
                                gpointer v);
 gboolean brisk_key_binder_unbind(BriskKeyBinder *self, const gchar *shortcut);
+gboolean brisk_key_binder_set_mode(BriskKeyBinder *self, BriskKeyBinderMode mode);
+gboolean brisk_key_binder_is_raw(BriskKeyBinder *self, const gchar *shortcut);
 
 G_END_DECLS
 
@@ -0,0 +1,351 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "trace.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+BRISK_END_PEDANTIC
+
+DEF_AUTOFREE(GPtrArray, g_ptr_array_unref)
+DEF_AUTOFREE(gchar, g_free)
+
+/**
+ * How many raw spans we keep before overwriting the oldest
+ */
+#define BRISK_TRACE_RING_SIZE 16384
+
+/**
+ * A single completed span
+ */
+typedef struct BriskTraceRecord {
+        const gchar *name; /**<Static name of the span */
+        gpointer thread;   /**<Thread the span ran on */
+        gint64 start;      /**<Monotonic start time */
+        gint64 duration;   /**<Length in microseconds */
+} BriskTraceRecord;
+
+/**
+ * Totals for every span of one name, kept even once the ring wraps
+ */
+typedef struct BriskTraceTotal {
+        const gchar *name; /**<Static name of the span */
+        guint64 count;     /**<Number of spans recorded */
+        gint64 total;      /**<Sum of all durations */
+        gint64 max;        /**<Longest single span */
+} BriskTraceTotal;
+
+/**
+ * Deepest nesting of spans we remember per thread
+ */
+#define BRISK_TRACE_STACK_DEPTH 32
+
+/**
+ * Open spans on a thread. Only the owning thread writes, the watchdog may
+ * read the main thread's stack at any time so depth is published last.
+ */
+typedef struct BriskTraceStack {
+        volatile gint depth;                         /**<Number of open spans */
+        const gchar *names[BRISK_TRACE_STACK_DEPTH]; /**<Names, outermost first */
+        gint64 starts[BRISK_TRACE_STACK_DEPTH];      /**<Start time of each span */
+} BriskTraceStack;
+
+/**
+ * Watchdog only ever checks the main loop
+ */
+typedef struct BriskTraceWatchdog {
+        GMutex lock;            /**<Protects last_beat */
+        gint64 last_beat;       /**<Last time the main loop iterated */
+        gint64 threshold;       /**<Stall threshold in microseconds */
+        BriskTraceStack *stack; /**<Main thread's open spans */
+} BriskTraceWatchdog;
+
+static GMutex brisk_trace_lock;
+static BriskTraceRecord brisk_trace_ring[BRISK_TRACE_RING_SIZE];
+static guint64 brisk_trace_head = 0;
+static GHashTable *brisk_trace_totals = NULL;
+static _Thread_local BriskTraceStack brisk_trace_stack = { 0 };
+static BriskTraceWatchdog brisk_trace_watchdog = { 0 };
+
+/**
+ * Write the trace out at exit if the environment asked for it
+ */
+static void brisk_trace_dump_at_exit(void)
+{
+        const gchar *path = g_getenv("BRISK_TRACE");
+        FILE *file = NULL;
+
+        if (g_str_equal(path, "-")) {
+                brisk_trace_dump(stderr);
+                return;
+        }
+
+        file = fopen(path, "w");
+        if (!file) {
+                g_warning("Unable to write trace to %s: %s", path, strerror(errno));
+                return;
+        }
+        brisk_trace_dump(file);
+        fclose(file);
+}
+
+/**
+ * Lazily set up our state on the first span, caller holds the lock
+ */
+static void brisk_trace_init_locked(void)
+{
+        if (brisk_trace_totals) {
+                return;
+        }
+
+        brisk_trace_totals = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+        if (g_getenv("BRISK_TRACE") != NULL) {
+                atexit(brisk_trace_dump_at_exit);
+        }
+}
+
+void brisk_trace_mark(const gchar *name, gint64 start, gint64 duration)
+{
+        BriskTraceRecord *record = NULL;
+        BriskTraceTotal *total = NULL;
+
+        g_mutex_lock(&brisk_trace_lock);
+        brisk_trace_init_locked();
+
+        record = &brisk_trace_ring[brisk_trace_head++ % BRISK_TRACE_RING_SIZE];
+        record->name = name;
+        record->thread = g_thread_self();
+        record->start = start;
+        record->duration = duration;
+
+        total = g_hash_table_lookup(brisk_trace_totals, name);
+        if (!total) {
+                total = g_new0(BriskTraceTotal, 1);
+                total->name = name;
+                g_hash_table_insert(brisk_trace_totals, (gpointer)name, total);
+        }
+        ++total->count;
+        total->total += duration;
+        total->max = MAX(total->max, duration);
+
+        g_mutex_unlock(&brisk_trace_lock);
+}
+
+void brisk_trace_enter(const gchar *name, gint64 start)
+{
+        gint depth = brisk_trace_stack.depth;
+
+        if (depth < BRISK_TRACE_STACK_DEPTH) {
+                brisk_trace_stack.names[depth] = name;
+                brisk_trace_stack.starts[depth] = start;
+        }
+        g_atomic_int_set(&brisk_trace_stack.depth, depth + 1);
+}
+
+void brisk_trace_leave(void)
+{
+        g_atomic_int_add(&brisk_trace_stack.depth, -1);
+}
+
+/**
+ * Describe what the main thread is doing, outermost span first
+ */
+static gchar *brisk_trace_watchdog_describe(BriskTraceStack *stack, gint64 now)
+{
+        GString *desc = NULL;
+        gint depth = MIN(g_atomic_int_get(&stack->depth), BRISK_TRACE_STACK_DEPTH);
+
+        if (depth <= 0) {
+                return g_strdup("no traced span");
+        }
+
+        desc = g_string_new(NULL);
+        for (gint i = 0; i < depth; i++) {
+                g_string_append_printf(desc,
+                                       "%s%s (%" G_GINT64_FORMAT "ms)",
+                                       i > 0 ? " > " : "",
+                                       stack->names[i],
+                                       (now - stack->starts[i]) / 1000);
+        }
+        return g_string_free(desc, FALSE);
+}
+
+/**
+ * Runs on the main loop at high priority, so it only falls behind when the
+ * loop itself is blocked
+ */
+static gboolean brisk_trace_watchdog_beat(__brisk_unused__ gpointer v)
+{
+        BriskTraceWatchdog *self = &brisk_trace_watchdog;
+        gint64 now = g_get_monotonic_time();
+        gint64 gap = 0;
+
+        g_mutex_lock(&self->lock);
+        gap = now - self->last_beat;
+        self->last_beat = now;
+        g_mutex_unlock(&self->lock);
+
+        if (gap > self->threshold) {
+                g_warning("Main loop stalled for %" G_GINT64_FORMAT "ms", gap / 1000);
+        }
+
+        return G_SOURCE_CONTINUE;
+}
+
+/**
+ * Poll the heartbeat, and report once per stall while it's still happening
+ * so we name whatever is holding up the main thread
+ */
+static gpointer brisk_trace_watchdog_thread(__brisk_unused__ gpointer v)
+{
+        BriskTraceWatchdog *self = &brisk_trace_watchdog;
+        gboolean reported = FALSE;
+
+        for (;;) {
+                autofree(gchar) *desc = NULL;
+                gint64 now = 0;
+                gint64 stalled = 0;
+
+                g_usleep((gulong)(self->threshold / 4));
+
+                now = g_get_monotonic_time();
+                g_mutex_lock(&self->lock);
+                stalled = now - self->last_beat;
+                g_mutex_unlock(&self->lock);
+
+                /* Beats come every half threshold, so one may be late */
+                if (stalled <= self->threshold) {
+                        reported = FALSE;
+                        continue;
+                }
+                if (reported) {
+                        continue;
+                }
+
+                desc = brisk_trace_watchdog_describe(self->stack, now);
+                g_warning("Main loop blocked for %" G_GINT64_FORMAT "ms in %s",
+                          stalled / 1000,
+                          desc);
+                reported = TRUE;
+        }
+
+        return NULL;
+}
+
+void brisk_trace_watchdog_init(void)
+{
+        BriskTraceWatchdog *self = &brisk_trace_watchdog;
+        const gchar *threshold = g_getenv("BRISK_WATCHDOG");
+        guint64 ms = 0;
+
+        if (!threshold || self->stack) {
+                return;
+        }
+
+        ms = g_ascii_strtoull(threshold, NULL, 10);
+        if (ms < 10) {
+                g_warning("BRISK_WATCHDOG must be at least 10ms, not starting watchdog");
+                return;
+        }
+
+        self->stack = &brisk_trace_stack;
+        self->threshold = (gint64)ms * 1000;
+        self->last_beat = g_get_monotonic_time();
+
+        g_timeout_add_full(G_PRIORITY_HIGH,
+                           (guint)(ms / 2),
+                           brisk_trace_watchdog_beat,
+                           NULL,
+                           NULL);
+        g_thread_unref(g_thread_new("brisk-watchdog", brisk_trace_watchdog_thread, NULL));
+}
+
+/**
+ * Sort the totals so the most expensive spans come first
+ */
+static gint brisk_trace_sort_total(gconstpointer a, gconstpointer b)
+{
+        const BriskTraceTotal *totalA = *(const BriskTraceTotal **)a;
+        const BriskTraceTotal *totalB = *(const BriskTraceTotal **)b;
+
+        if (totalA->total == totalB->total) {
+                return g_strcmp0(totalA->name, totalB->name);
+        }
+        return totalA->total > totalB->total ? -1 : 1;
+}
+
+void brisk_trace_dump(FILE *file)
+{
+        autofree(GPtrArray) *totals = NULL;
+        GHashTableIter iter;
+        gpointer value = NULL;
+        guint64 first = 0;
+
+        g_mutex_lock(&brisk_trace_lock);
+        brisk_trace_init_locked();
+
+        totals = g_ptr_array_sized_new(g_hash_table_size(brisk_trace_totals));
+        g_hash_table_iter_init(&iter, brisk_trace_totals);
+        while (g_hash_table_iter_next(&iter, NULL, &value)) {
+                g_ptr_array_add(totals, value);
+        }
+        g_ptr_array_sort(totals, brisk_trace_sort_total);
+
+        fprintf(file, "# span\tcount\ttotal_us\tmean_us\tmax_us\n");
+        for (guint i = 0; i < totals->len; i++) {
+                BriskTraceTotal *total = totals->pdata[i];
+                fprintf(file,
+                        "%s\t%" G_GUINT64_FORMAT "\t%" G_GINT64_FORMAT "\t%.2f\t%" G_GINT64_FORMAT
+                        "\n",
+                        total->name,
+                        total->count,
+                        total->total,
+                        (gdouble)total->total / (gdouble)total->count,
+                        total->max);
+        }
+
+        /* Raw spans, oldest first */
+        fprintf(file, "\n# span\tthread\tstart_us\tduration_us\n");
+        if (brisk_trace_head > BRISK_TRACE_RING_SIZE) {
+                first = brisk_trace_head - BRISK_TRACE_RING_SIZE;
+        }
+        for (guint64 i = first; i < brisk_trace_head; i++) {
+                BriskTraceRecord *record = &brisk_trace_ring[i % BRISK_TRACE_RING_SIZE];
+                fprintf(file,
+                        "%s\t%p\t%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "\n",
+                        record->name,
+                        record->thread,
+                        record->start,
+                        record->duration);
+        }
+
+        g_mutex_unlock(&brisk_trace_lock);
+        fflush(file);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
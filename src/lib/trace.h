@@ -0,0 +1,122 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include <glib.h>
+#include <stdio.h>
+BRISK_END_PEDANTIC
+
+G_BEGIN_DECLS
+
+#if defined(BRISK_ENABLE_TRACING)
+
+/**
+ * An open span, closed automatically when it leaves scope
+ */
+typedef struct BriskTraceSpan {
+        const gchar *name; /**<Static name of the span */
+        gint64 start;      /**<Monotonic time the span was opened */
+} BriskTraceSpan;
+
+/**
+ * brisk_trace_mark:
+ * @name: Static string naming the span, compared by pointer
+ * @start: Monotonic time at which the span began
+ * @duration: Length of the span in microseconds
+ *
+ * Record a completed span in the trace ring buffer. Safe to call from any
+ * thread.
+ */
+void brisk_trace_mark(const gchar *name, gint64 start, gint64 duration);
+
+/**
+ * brisk_trace_dump:
+ * @file: Where to write the trace
+ *
+ * Write per-span totals followed by the most recent raw spans to @file.
+ * This also happens automatically at exit when BRISK_TRACE is set in the
+ * environment, naming the file to write to, or "-" for stderr.
+ */
+void brisk_trace_dump(FILE *file);
+
+/**
+ * Maintain the per-thread stack of open spans, so the watchdog can tell
+ * what the main thread is busy with
+ */
+void brisk_trace_enter(const gchar *name, gint64 start);
+void brisk_trace_leave(void);
+
+/**
+ * brisk_trace_watchdog_init:
+ *
+ * Must be called from the main thread. When BRISK_WATCHDOG is set to a
+ * threshold in milliseconds, a watchdog thread logs the open spans of the
+ * main thread whenever the main loop fails to iterate for that long.
+ */
+void brisk_trace_watchdog_init(void);
+
+static inline BriskTraceSpan brisk_trace_span_begin(const gchar *name)
+{
+        BriskTraceSpan span = { .name = name, .start = g_get_monotonic_time() };
+
+        brisk_trace_enter(span.name, span.start);
+        return span;
+}
+
+static inline void brisk_trace_span_end(BriskTraceSpan *span)
+{
+        brisk_trace_leave();
+        brisk_trace_mark(span->name, span->start, g_get_monotonic_time() - span->start);
+}
+
+#define _BRISK_TRACE_CONCAT(a, b) a##b
+#define _BRISK_TRACE_SPAN(l) _BRISK_TRACE_CONCAT(_brisk_trace_span_, l)
+
+/**
+ * Open a span lasting until the end of the enclosing scope
+ */
+#define brisk_trace_span(name)                                                                     \
+        __attribute__((cleanup(brisk_trace_span_end)))                                             \
+        __brisk_unused__ BriskTraceSpan _BRISK_TRACE_SPAN(__LINE__) = brisk_trace_span_begin(name)
+
+#else /* BRISK_ENABLE_TRACING */
+
+/**
+ * Tracing is disabled, so trace points compile away entirely
+ */
+#define brisk_trace_span(name)                                                                     \
+        do {                                                                                       \
+        } while (0)
+
+#define brisk_trace_watchdog_init()                                                                \
+        do {                                                                                       \
+        } while (0)
+
+#endif /* BRISK_ENABLE_TRACING */
+
+G_END_DECLS
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -32,6 +32,13 @@ static gint icon_sizes[] = { 16, 24, 32, 48, 64, 96, 128, 256 };
 
 DEF_AUTOFREE(NotifyNotification, g_object_unref)
 
+/**
+ * How long to wait once the panel has first gone idle before creating the
+ * menu when deferred, giving the rest of the session a chance to start
+ * first (seconds)
+ */
+#define BRISK_APPLET_DEFER_DELAY 5
+
 /**
  * Handle showing of the menu
  */
@@ -42,6 +49,8 @@ static void brisk_menu_applet_change_menu_orient(BriskMenuApplet *self);
 
 static gboolean brisk_menu_applet_startup(BriskMenuApplet *self);
 static void brisk_menu_applet_create_window(BriskMenuApplet *self);
+static void brisk_menu_applet_defer_window(BriskMenuApplet *self);
+static void brisk_menu_applet_ensure_window(BriskMenuApplet *self);
 
 /* Handle applet settings */
 void brisk_menu_applet_init_settings(BriskMenuApplet *self);
@@ -64,6 +73,17 @@ static void brisk_menu_applet_dispose(GObject *obj)
 
         self = BRISK_MENU_APPLET(obj);
 
+        if (self->deferred_id) {
+                g_source_remove(self->deferred_id);
+                self->deferred_id = 0;
+        }
+        if (self->hotkey_id) {
+                g_source_remove(self->hotkey_id);
+                self->hotkey_id = 0;
+        }
+        g_clear_object(&self->binder);
+        g_clear_pointer(&self->shortcut, g_free);
+
         /* Tear down the menu */
         if (self->menu) {
                 gtk_widget_hide(self->menu);
@@ -181,9 +201,6 @@ static void brisk_menu_applet_create_window(BriskMenuApplet *self)
 {
         GtkWidget *menu = NULL;
 
-        /* Now show all content */
-        gtk_widget_show_all(self->toggle);
-
         /* Construct our menu */
         WindowType window_type = g_settings_get_enum(self->settings, "window-type");
         switch (window_type) {
@@ -216,24 +233,159 @@ static void brisk_menu_applet_create_window(BriskMenuApplet *self)
 }
 
 /**
- * Toggle the menu visibility on a button press
+ * Toggle the menu visibility, creating it first if we've not yet done so
  */
-static gboolean button_press_cb(BriskMenuApplet *self, GdkEvent *event, __brisk_unused__ gpointer v)
+static void brisk_menu_applet_toggle(BriskMenuApplet *self)
 {
-        if (event->button.button != 1) {
-                return GDK_EVENT_PROPAGATE;
-        }
+        brisk_menu_applet_ensure_window(self);
 
         gboolean vis = !gtk_widget_get_visible(self->menu);
         if (vis) {
+                brisk_menu_window_latency_begin(BRISK_MENU_WINDOW(self->menu),
+                                                BRISK_MENU_LATENCY_OPEN);
                 brisk_menu_window_update_screen_position(BRISK_MENU_WINDOW(self->menu));
         }
 
         gtk_widget_set_visible(self->menu, vis);
+}
+
+/**
+ * Toggle the menu visibility on a button press
+ */
+static gboolean button_press_cb(BriskMenuApplet *self, GdkEvent *event, __brisk_unused__ gpointer v)
+{
+        if (event->button.button != 1) {
+                return GDK_EVENT_PROPAGATE;
+        }
+
+        brisk_menu_applet_toggle(self);
 
         return GDK_EVENT_STOP;
 }
 
+/**
+ * Startup has settled, so the menu can be built without getting in the way
+ */
+static gboolean brisk_menu_applet_deferred_timeout(BriskMenuApplet *self)
+{
+        self->deferred_id = 0;
+        brisk_menu_applet_ensure_window(self);
+        return G_SOURCE_REMOVE;
+}
+
+/**
+ * Nothing more important is left to run, so start counting down the delay.
+ * The timeout replaces us in deferred_id.
+ */
+static gboolean brisk_menu_applet_deferred_idle(BriskMenuApplet *self)
+{
+        self->deferred_id = g_timeout_add_seconds(BRISK_APPLET_DEFER_DELAY,
+                                                  (GSourceFunc)brisk_menu_applet_deferred_timeout,
+                                                  self);
+        return G_SOURCE_REMOVE;
+}
+
+/**
+ * The pointer is heading for the button, so a click is likely on its way.
+ * Backends load in the background, so the window is ready to show well
+ * before the click lands.
+ */
+static gboolean brisk_menu_applet_enter_cb(BriskMenuApplet *self,
+                                           __brisk_unused__ GdkEvent *event,
+                                           __brisk_unused__ gpointer v)
+{
+        brisk_menu_applet_ensure_window(self);
+        return GDK_EVENT_PROPAGATE;
+}
+
+/**
+ * Open the menu for a hotkey pressed before it existed. We're called from
+ * within the binder's event filter, so leave the work to the main loop.
+ */
+static gboolean brisk_menu_applet_hotkey_idle(BriskMenuApplet *self)
+{
+        self->hotkey_id = 0;
+        brisk_menu_applet_toggle(self);
+        return G_SOURCE_REMOVE;
+}
+
+static void brisk_menu_applet_hotkey_cb(__brisk_unused__ GdkEvent *event, gpointer v)
+{
+        BriskMenuApplet *self = v;
+
+        if (self->hotkey_id) {
+                return;
+        }
+        self->hotkey_id = g_idle_add((GSourceFunc)brisk_menu_applet_hotkey_idle, self);
+}
+
+/**
+ * brisk_menu_applet_defer_window:
+ *
+ * Put off creating the menu and loading its backends until the panel has
+ * been idle for a while, or the user reaches for the menu by pointer or
+ * hotkey, whichever comes first. Until then we hold the hotkey ourselves.
+ */
+static void brisk_menu_applet_defer_window(BriskMenuApplet *self)
+{
+        autofree(gchar) *shortcut = NULL;
+
+        if (self->deferred_id || self->binder) {
+                return;
+        }
+
+        /* The delay only starts once the low priority idle gets to run,
+         * i.e. when the panel has nothing else left to do */
+        self->deferred_id = g_idle_add_full(G_PRIORITY_LOW,
+                                            (GSourceFunc)brisk_menu_applet_deferred_idle,
+                                            self,
+                                            NULL);
+
+        g_signal_connect_swapped(self->toggle,
+                                 "enter-notify-event",
+                                 G_CALLBACK(brisk_menu_applet_enter_cb),
+                                 self);
+
+        shortcut = g_settings_get_string(self->settings, "hot-key");
+        self->binder = brisk_key_binder_new();
+        if (g_settings_get_boolean(self->settings, "hot-key-raw")) {
+                brisk_key_binder_set_mode(self->binder, BRISK_KEY_BINDER_MODE_RAW);
+        }
+        if (brisk_key_binder_bind(self->binder, shortcut, brisk_menu_applet_hotkey_cb, self)) {
+                self->shortcut = g_strdup(shortcut);
+        }
+}
+
+/**
+ * brisk_menu_applet_ensure_window:
+ *
+ * Create the menu now if we haven't already
+ */
+static void brisk_menu_applet_ensure_window(BriskMenuApplet *self)
+{
+        if (self->menu) {
+                return;
+        }
+
+        if (self->deferred_id) {
+                g_source_remove(self->deferred_id);
+                self->deferred_id = 0;
+        }
+        g_signal_handlers_disconnect_by_func(self->toggle,
+                                             G_CALLBACK(brisk_menu_applet_enter_cb),
+                                             self);
+
+        /* Grabs belong to the X connection, so ours must go before the
+         * window's binder grabs the same key or we'd release both */
+        if (self->binder && self->shortcut) {
+                brisk_key_binder_unbind(self->binder, self->shortcut);
+        }
+        g_clear_object(&self->binder);
+        g_clear_pointer(&self->shortcut, g_free);
+
+        brisk_menu_applet_create_window(self);
+}
+
 /**
  * Callback for changing applet settings
  */
@@ -274,7 +426,14 @@ static void brisk_menu_applet_change_orient(MatePanelApplet *applet, MatePanelAp
         brisk_menu_applet_adapt_layout(BRISK_MENU_APPLET(applet));
 
         if (!self->menu) {
-                brisk_menu_applet_create_window(self);
+                /* Now show all content */
+                gtk_widget_show_all(self->toggle);
+
+                if (g_settings_get_boolean(self->settings, "defer-loading")) {
+                        brisk_menu_applet_defer_window(self);
+                } else {
+                        brisk_menu_applet_create_window(self);
+                }
                 return;
         }
 
@@ -310,7 +469,7 @@ void brisk_menu_applet_edit_menus(__brisk_unused__ GtkAction *action, BriskMenuA
         for (size_t i = 0; i < G_N_ELEMENTS(editors); i++) {
                 autofree(gchar) *p = NULL;
                 autofree(GAppInfo) *app = NULL;
-                BriskMenuLauncher *launcher = ((BRISK_MENU_WINDOW(self->menu))->launcher);
+                BriskMenuLauncher *launcher = NULL;
                 GDesktopAppInfo *info = NULL;
 
                 p = g_find_program_in_path(binaries[i]);
@@ -330,6 +489,8 @@ void brisk_menu_applet_edit_menus(__brisk_unused__ GtkAction *action, BriskMenuA
                 if (!app) {
                         continue;
                 }
+                brisk_menu_applet_ensure_window(self);
+                launcher = BRISK_MENU_WINDOW(self->menu)->launcher;
                 brisk_menu_launcher_start(launcher, GTK_WIDGET(self), app);
                 return;
         }
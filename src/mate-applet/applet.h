@@ -12,6 +12,7 @@
 #pragma once
 
 #include <glib-object.h>
+#include "key-binder.h"
 #include <gtk/gtk.h>
 #include <mate-panel-applet.h>
 
@@ -45,6 +46,10 @@ struct _BriskMenuApplet {
         GtkWidget *menu;              /**<BriskMenuWindow instance */
         GSettings *settings;          /**<Our settings store */
         MatePanelAppletOrient orient; /**<Current position for the panel */
+        guint deferred_id;            /**<Idle, then timeout, creating the menu */
+        guint hotkey_id;              /**<Opens the menu after an early hotkey */
+        BriskKeyBinder *binder;       /**<Holds the hotkey until the menu exists */
+        gchar *shortcut;              /**<Hotkey bound by our binder */
 };
 
 #define BRISK_TYPE_MENU_APPLET brisk_menu_applet_get_type()
@@ -17,6 +17,8 @@
 BRISK_BEGIN_PEDANTIC
 #include "applet.h"
 #include "brisk-resources.h"
+#include "frontend/menu-window.h"
+#include "trace.h"
 #include <glib/gi18n.h>
 #include <libnotify/notify.h>
 #include <mate-panel-applet.h>
@@ -93,6 +95,12 @@ static gboolean brisk_menu_applet_factory(MatePanelApplet *applet, const gchar *
                 notify_had_init = TRUE;
         }
 
+        /* Opt-in stall detection for tracing builds */
+        brisk_trace_watchdog_init();
+
+        /* The menu window is created lazily, but SIGUSR1 must never kill us */
+        brisk_menu_window_latency_init();
+
         /* Setup the action group and hand it to the mate panel */
         G_GNUC_BEGIN_IGNORE_DEPRECATIONS
         group = gtk_action_group_new("Brisk Menu Actions");
@@ -0,0 +1,302 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "backend/apps/apps-backend.h"
+#include "fixture.h"
+#include "menu-private.h"
+BRISK_END_PEDANTIC
+
+/**
+ * Default size of the synthetic tree
+ */
+#define BENCH_N_ENTRIES 5000
+
+/**
+ * Default number of root level sections in the tree
+ */
+#define BENCH_N_SECTIONS 12
+
+/**
+ * How many times we reload the backend
+ */
+#define BENCH_N_RUNS 5
+
+/**
+ * Typical query sequences, typed one keystroke at a time
+ */
+static const gchar *bench_queries[] = {
+        "fixture application 42",
+        "synthetic",
+        "tool 9",
+        "entry4999",
+        "zzzz",
+};
+
+DEF_AUTOFREE(BriskBackend, g_object_unref)
+DEF_AUTOFREE(GPtrArray, g_ptr_array_unref)
+DEF_AUTOFREE(gchar, g_free)
+
+/**
+ * Everything the backend has emitted since the last reset
+ */
+typedef struct BenchState {
+        GPtrArray *items;
+        gboolean loaded;
+        gint64 reset_time; /**<When the backend last reset itself */
+} BenchState;
+
+/**
+ * Timings for a single run over one fixture
+ */
+typedef struct BenchResult {
+        guint n_items;
+        gint64 cold_load;
+        gint64 reload_best;
+        gint64 reload_total;
+        gint64 search_total;
+        gint64 search_max;
+        guint n_keystrokes;
+        gint64 sort_name;
+} BenchResult;
+
+static void bench_item_added(__brisk_unused__ BriskBackend *backend, BriskItem *item,
+                             BenchState *state)
+{
+        g_ptr_array_add(state->items, g_object_ref_sink(item));
+}
+
+static void bench_load_finished(__brisk_unused__ BriskBackend *backend,
+                                __brisk_unused__ const BriskBackendLoadStats *stats,
+                                BenchState *state)
+{
+        state->loaded = TRUE;
+}
+
+static void bench_reset(__brisk_unused__ BriskBackend *backend, BenchState *state)
+{
+        g_ptr_array_set_size(state->items, 0);
+        state->loaded = FALSE;
+        state->reset_time = g_get_monotonic_time();
+}
+
+/**
+ * Trees are loaded on worker threads, so spin the loop until the backend
+ * tells us it has finished. Returns the time taken in microseconds.
+ */
+static gint64 bench_load(BriskBackend *backend, BenchState *state, guint n_entries)
+{
+        gint64 start = g_get_monotonic_time();
+        gint64 elapsed = 0;
+
+        if (!brisk_backend_load(backend)) {
+                g_error("Failed to load the apps backend");
+        }
+
+        while (!state->loaded) {
+                g_main_context_iteration(NULL, TRUE);
+        }
+        elapsed = g_get_monotonic_time() - start;
+
+        /* No entry may be lost */
+        if (state->items->len < n_entries) {
+                g_error("Incomplete load: %u items", state->items->len);
+        }
+
+        return elapsed;
+}
+
+/**
+ * Reload just as an install or removal would, by way of the app info monitor.
+ * The backend waits out its debounce first, so we time from its reset until
+ * it has finished loading again.
+ */
+static gint64 bench_reload(BriskBackend *backend, BenchState *state, guint n_entries)
+{
+        GAppInfoMonitor *monitor = g_app_info_monitor_get();
+
+        state->loaded = FALSE;
+        state->reset_time = 0;
+        g_signal_emit_by_name(monitor, "changed");
+        g_object_unref(monitor);
+
+        while (!state->loaded) {
+                g_main_context_iteration(NULL, TRUE);
+        }
+
+        if (state->reset_time == 0) {
+                g_error("Backend reloaded without a reset");
+        }
+        if (state->items->len < n_entries) {
+                g_error("Incomplete reload: %u items", state->items->len);
+        }
+
+        return g_get_monotonic_time() - state->reset_time;
+}
+
+static gint bench_sort_name(gconstpointer a, gconstpointer b)
+{
+        return brisk_menu_sort_items(*(BriskItem **)a, *(BriskItem **)b, NULL, NULL);
+}
+
+static gint bench_sort_search(gconstpointer a, gconstpointer b, gpointer term)
+{
+        return brisk_menu_sort_items(*(BriskItem **)a, *(BriskItem **)b, term, NULL);
+}
+
+/**
+ * Sort every item by name, as the frontend does when no search is active
+ */
+static gint64 bench_sort(BenchState *state)
+{
+        autofree(GPtrArray) *sorted = g_ptr_array_sized_new(state->items->len);
+        gint64 start = 0;
+
+        for (guint i = 0; i < state->items->len; i++) {
+                g_ptr_array_add(sorted, g_ptr_array_index(state->items, i));
+        }
+
+        start = g_get_monotonic_time();
+        g_ptr_array_sort(sorted, bench_sort_name);
+        return g_get_monotonic_time() - start;
+}
+
+/**
+ * Emulate a single keystroke: filter every item on the term, then sort the
+ * results by their score, just as the frontend does.
+ */
+static gint64 bench_keystroke(BenchState *state, gchar *term)
+{
+        autofree(GPtrArray) *matches = g_ptr_array_new();
+        gint64 start = g_get_monotonic_time();
+
+        for (guint i = 0; i < state->items->len; i++) {
+                BriskItem *item = g_ptr_array_index(state->items, i);
+                if (brisk_item_matches_search(item, term)) {
+                        g_ptr_array_add(matches, item);
+                }
+        }
+        g_ptr_array_sort_with_data(matches, bench_sort_search, term);
+
+        return g_get_monotonic_time() - start;
+}
+
+static void bench_search(BenchState *state, BenchResult *result)
+{
+        for (guint i = 0; i < G_N_ELEMENTS(bench_queries); i++) {
+                for (size_t len = 1; len <= strlen(bench_queries[i]); len++) {
+                        autofree(gchar) *term = g_ascii_strdown(bench_queries[i], (gssize)len);
+                        gint64 elapsed = bench_keystroke(state, term);
+
+                        result->search_total += elapsed;
+                        result->search_max = MAX(result->search_max, elapsed);
+                        ++result->n_keystrokes;
+                }
+        }
+}
+
+static void bench_run(BenchResult *result, guint n_entries)
+{
+        autofree(BriskBackend) *backend = NULL;
+        BenchState state = { 0 };
+
+        state.items = g_ptr_array_new_with_free_func(g_object_unref);
+
+        backend = brisk_apps_backend_new();
+        g_signal_connect(backend, "item-added", G_CALLBACK(bench_item_added), &state);
+        g_signal_connect(backend, "load-finished", G_CALLBACK(bench_load_finished), &state);
+        g_signal_connect(backend, "reset", G_CALLBACK(bench_reset), &state);
+
+        result->cold_load = bench_load(backend, &state, n_entries);
+        result->reload_best = G_MAXINT64;
+
+        /* Warm reloads reuse everything the backend has cached */
+        for (guint i = 0; i < BENCH_N_RUNS; i++) {
+                gint64 elapsed = bench_reload(backend, &state, n_entries);
+
+                result->reload_best = MIN(result->reload_best, elapsed);
+                result->reload_total += elapsed;
+        }
+
+        result->n_items = state.items->len;
+        bench_search(&state, result);
+        result->sort_name = bench_sort(&state);
+
+        g_ptr_array_unref(state.items);
+}
+
+/**
+ * Emit the results as JSON so they can be tracked between releases
+ */
+static void bench_print(BenchResult *result, guint n_entries)
+{
+        printf("{\n"
+               "  \"entries\": %u,\n"
+               "  \"items\": %u,\n"
+               "  \"cold_load_ms\": %.3f,\n"
+               "  \"warm_reload_best_ms\": %.3f,\n"
+               "  \"warm_reload_mean_ms\": %.3f,\n"
+               "  \"search_keystrokes\": %u,\n"
+               "  \"search_keystroke_mean_ms\": %.3f,\n"
+               "  \"search_keystroke_max_ms\": %.3f,\n"
+               "  \"sort_name_ms\": %.3f\n"
+               "}\n",
+               n_entries,
+               result->n_items,
+               (double)result->cold_load / 1000.0,
+               (double)result->reload_best / 1000.0,
+               (double)result->reload_total / BENCH_N_RUNS / 1000.0,
+               result->n_keystrokes,
+               (double)result->search_total / MAX(result->n_keystrokes, 1) / 1000.0,
+               (double)result->search_max / 1000.0,
+               (double)result->sort_name / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+        BriskFixture *fixture = NULL;
+        BenchResult result = { 0 };
+        guint n_entries = BENCH_N_ENTRIES;
+
+        if (argc > 1) {
+                n_entries = (guint)strtoul(argv[1], NULL, 10);
+        }
+
+        fixture = brisk_fixture_new(n_entries, BENCH_N_SECTIONS);
+        brisk_fixture_export(fixture);
+
+        bench_run(&result, n_entries);
+        bench_print(&result, n_entries);
+
+        brisk_fixture_free(fixture);
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,106 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "fixture.h"
+BRISK_END_PEDANTIC
+
+DEF_AUTOFREE(GOptionContext, g_option_context_free)
+
+int main(int argc, char **argv)
+{
+        autofree(GOptionContext) *context = NULL;
+        BriskFixtureConfig config = { 0 };
+        BriskFixture *fixture = NULL;
+        GError *error = NULL;
+        gint n_entries = 0;
+        gint n_sections = 0;
+        gint n_keywords = 0;
+        gint n_locales = 0;
+        gint n_actions = 0;
+        gint seed = 0;
+
+        brisk_fixture_config_init(&config);
+        n_entries = (gint)config.n_entries;
+        n_sections = (gint)config.n_sections;
+
+        GOptionEntry entries[] = {
+                { "entries", 'n', 0, G_OPTION_ARG_INT, &n_entries, "Desktop entries", "N" },
+                { "sections", 's', 0, G_OPTION_ARG_INT, &n_sections, "Root level menus", "N" },
+                { "skew",
+                  'z',
+                  0,
+                  G_OPTION_ARG_DOUBLE,
+                  &config.skew,
+                  "Zipf exponent of the category distribution (0 is uniform)",
+                  "S" },
+                { "keywords", 'k', 0, G_OPTION_ARG_INT, &n_keywords, "Keywords per entry", "N" },
+                { "locales", 'l', 0, G_OPTION_ARG_INT, &n_locales, "Translations per entry", "N" },
+                { "actions", 'a', 0, G_OPTION_ARG_INT, &n_actions, "Actions per entry", "N" },
+                { "unicode", 'u', 0, G_OPTION_ARG_NONE, &config.unicode, "Non-ASCII names", NULL },
+                { "seed", 0, 0, G_OPTION_ARG_INT, &seed, "Random seed", "N" },
+                { NULL, 0, 0, 0, NULL, NULL, NULL },
+        };
+
+        context = g_option_context_new("DIRECTORY - generate a synthetic menu tree");
+        g_option_context_add_main_entries(context, entries, NULL);
+        if (!g_option_context_parse(context, &argc, &argv, &error)) {
+                fprintf(stderr, "%s\n", error->message);
+                g_error_free(error);
+                return EXIT_FAILURE;
+        }
+
+        if (argc != 2 || n_entries < 0 || n_sections < 1 || n_keywords < 0 || n_locales < 0 ||
+            n_actions < 0) {
+                fputs("Usage: brisk-fixture-gen [OPTION...] DIRECTORY\n", stderr);
+                return EXIT_FAILURE;
+        }
+
+        config.n_entries = (guint)n_entries;
+        config.n_sections = (guint)n_sections;
+        config.n_keywords = (guint)n_keywords;
+        config.n_locales = (guint)n_locales;
+        config.n_actions = (guint)n_actions;
+        config.seed = (guint32)seed;
+
+        fixture = brisk_fixture_new_full(&config, argv[1]);
+
+        /* Show how to point brisk at the tree */
+        printf("XDG_DATA_DIRS=%s/data XDG_DATA_HOME=%s/data-home "
+               "XDG_CONFIG_DIRS=%s/config XDG_CONFIG_HOME=%s/config-home\n",
+               fixture->root,
+               fixture->root,
+               fixture->root,
+               fixture->root);
+
+        brisk_fixture_free(fixture);
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -21,10 +21,37 @@
 
 BRISK_BEGIN_PEDANTIC
 #include "backend/apps/apps-backend.h"
+#include "backend/apps/apps-info-cache.h"
+#include "fixture.h"
+#include <glib/gstdio.h>
 BRISK_END_PEDANTIC
 
+/**
+ * Size of the synthetic tree we load
+ */
+#define TEST_N_ENTRIES 200
+#define TEST_N_SECTIONS 8
+#define TEST_N_ACTIONS 2
+
+/**
+ * Entries outside the XDG data dirs, which GIO gives no desktop ID
+ */
+#define TEST_N_EXTERNAL 2
+
+/**
+ * Give up if loading takes longer than this
+ */
+#define TEST_TIMEOUT 30
+
+/**
+ * Program that only exists in our own $PATH directory, for TryExec
+ */
+#define TEST_TRYEXEC "brisk-test-tryexec"
+
 DEF_AUTOFREE(BriskBackend, g_object_unref)
+DEF_AUTOFREE(GDesktopAppInfo, g_object_unref)
 DEF_AUTOFREE(char, free)
+DEF_AUTOFREE(gchar, g_free)
 
 /**
  * Mimic functionality from check library
@@ -50,19 +77,88 @@ static inline void fail_if(bool b, const char *fmt, ...)
         exit(1);
 }
 
+static guint n_items = 0;
+static guint n_actions = 0;
+static guint n_external = 0;
+static guint n_sections = 0;
+static gboolean started = FALSE;
+
 static void test_item_added(__brisk_unused__ BriskBackend *backend, BriskItem *item,
                             __brisk_unused__ gpointer v)
 {
+        fail_if(!started, "Item emitted before load-started");
+        fail_if(brisk_item_get_id(item) == NULL,
+                "Item \"%s\" has no ID",
+                brisk_item_get_name(item));
         g_message("Got a new item: %s \"%s\"", brisk_item_get_id(item), brisk_item_get_name(item));
+        ++n_items;
+        if (brisk_item_get_parent(item) != NULL) {
+                ++n_actions;
+        }
+        /* Items without a desktop ID fall back to their file path */
+        if (g_path_is_absolute(brisk_item_get_id(item))) {
+                ++n_external;
+        }
 }
 
 static void test_section_added(__brisk_unused__ BriskBackend *backend, BriskSection *section,
                                __brisk_unused__ gpointer v)
 {
-        fputs("\n", stdout);
-        g_message("Got a new section: %s \"%s\"\n",
+        fail_if(!started, "Section emitted before load-started");
+        g_message("Got a new section: %s \"%s\"",
                   brisk_section_get_id(section),
                   brisk_section_get_name(section));
+        ++n_sections;
+}
+
+static void test_load_started(__brisk_unused__ BriskBackend *backend, __brisk_unused__ gpointer v)
+{
+        started = TRUE;
+}
+
+/**
+ * Loading is complete, so verify what we got and stop the loop
+ */
+static void test_load_finished(__brisk_unused__ BriskBackend *backend,
+                               const BriskBackendLoadStats *stats, GMainLoop *loop)
+{
+        fail_if(!started, "load-finished without load-started");
+        fail_if(stats->n_items != n_items,
+                "Stats claim %u items, got %u",
+                stats->n_items,
+                n_items);
+        fail_if(stats->n_sections != n_sections,
+                "Stats claim %u sections, got %u",
+                stats->n_sections,
+                n_sections);
+
+        /* Each desktop file and action is emitted exactly once, even when in both menus */
+        fail_if(n_items != TEST_N_ENTRIES * (1 + TEST_N_ACTIONS) + TEST_N_EXTERNAL,
+                "Expected %d items, got %u",
+                TEST_N_ENTRIES * (1 + TEST_N_ACTIONS) + TEST_N_EXTERNAL,
+                n_items);
+        fail_if(n_actions != TEST_N_ENTRIES * TEST_N_ACTIONS,
+                "Expected %d actions, got %u",
+                TEST_N_ENTRIES * TEST_N_ACTIONS,
+                n_actions);
+        fail_if(n_external != TEST_N_EXTERNAL,
+                "Expected %d items without a desktop ID, got %u",
+                TEST_N_EXTERNAL,
+                n_external);
+
+        /* Fixture sections, settings and the external one */
+        fail_if(n_sections != TEST_N_SECTIONS + 2,
+                "Expected %d sections, got %u",
+                TEST_N_SECTIONS + 2,
+                n_sections);
+
+        g_main_loop_quit(loop);
+}
+
+static gboolean test_timeout(__brisk_unused__ gpointer v)
+{
+        fail_if(true, "Timed out waiting for load-finished");
+        return G_SOURCE_REMOVE;
 }
 
 /**
@@ -75,17 +171,148 @@ static void run_apps_backend_test(BriskBackend *backend, GMainLoop *loop)
 
         g_signal_connect(backend, "item-added", G_CALLBACK(test_item_added), NULL);
         g_signal_connect(backend, "section-added", G_CALLBACK(test_section_added), NULL);
+        g_signal_connect(backend, "load-started", G_CALLBACK(test_load_started), NULL);
+        g_signal_connect(backend, "load-finished", G_CALLBACK(test_load_finished), loop);
 
         fail_if(!brisk_backend_load(backend), "Failed to load the apps backend");
 
-        /* Stop processing after 5 seconds */
-        g_timeout_add_seconds(5, (GSourceFunc)g_main_loop_quit, loop);
+        /* Only a safety net, we quit as soon as loading finishes */
+        g_timeout_add_seconds(TEST_TIMEOUT, test_timeout, NULL);
+}
+
+static void test_write(const gchar *path, const gchar *contents, int mode)
+{
+        GError *error = NULL;
+
+        fail_if(!g_file_set_contents(path, contents, -1, &error),
+                "Failed to write %s: %s",
+                path,
+                error ? error->message : "unknown error");
+        fail_if(g_chmod(path, mode) != 0, "Failed to chmod %s", path);
+}
+
+/**
+ * Drive the info cache through the reloads that matter: nothing changed,
+ * one desktop file changed, and a binary vanishing from $PATH.
+ */
+static void run_info_cache_test(void)
+{
+        autofree(gchar) *dir = NULL;
+        autofree(gchar) *bindir = NULL;
+        autofree(gchar) *bin = NULL;
+        autofree(gchar) *path = NULL;
+        autofree(gchar) *plain = NULL;
+        autofree(gchar) *tryexec = NULL;
+        autofree(GDesktopAppInfo) *plain1 = NULL;
+        autofree(GDesktopAppInfo) *plain2 = NULL;
+        autofree(GDesktopAppInfo) *plain3 = NULL;
+        autofree(GDesktopAppInfo) *plain4 = NULL;
+        autofree(GDesktopAppInfo) *plain5 = NULL;
+        autofree(GDesktopAppInfo) *plain6 = NULL;
+        autofree(GDesktopAppInfo) *tryexec1 = NULL;
+        autofree(GDesktopAppInfo) *tryexec2 = NULL;
+        autofree(GDesktopAppInfo) *tryexec3 = NULL;
+        autofree(GDesktopAppInfo) *tryexec4 = NULL;
+        autofree(GDesktopAppInfo) *tryexec5 = NULL;
+        autofree(GDesktopAppInfo) *tryexec6 = NULL;
+        BriskAppsInfoCache *cache = NULL;
+
+        dir = g_dir_make_tmp("brisk-test-cache-XXXXXX", NULL);
+        fail_if(!dir, "Failed to create a temporary directory");
+        bindir = g_build_filename(dir, "bin", NULL);
+        fail_if(g_mkdir(bindir, 0755) != 0, "Failed to create %s", bindir);
+        bin = g_build_filename(bindir, TEST_TRYEXEC, NULL);
+        plain = g_build_filename(dir, "plain.desktop", NULL);
+        tryexec = g_build_filename(dir, "tryexec.desktop", NULL);
+
+        test_write(bin, "#!/bin/sh\n", 0755);
+        test_write(plain, "[Desktop Entry]\nType=Application\nName=Plain\nExec=true\n", 0644);
+        test_write(tryexec,
+                   "[Desktop Entry]\nType=Application\nName=TryExec\n"
+                   "TryExec=" TEST_TRYEXEC "\nExec=" TEST_TRYEXEC "\n",
+                   0644);
+
+        /* Desktop files live elsewhere, so rewriting them leaves $PATH alone */
+        path = g_strdup_printf("%s%s%s", bindir, G_SEARCHPATH_SEPARATOR_S, g_getenv("PATH"));
+        g_setenv("PATH", path, TRUE);
+
+        cache = brisk_apps_info_cache_new();
+
+        /* First load parses everything */
+        fail_if(!brisk_apps_info_cache_begin(cache), "First load didn't start empty");
+        plain1 = brisk_apps_info_cache_lookup(cache, plain);
+        tryexec1 = brisk_apps_info_cache_lookup(cache, tryexec);
+        fail_if(!plain1, "Failed to load %s", plain);
+        fail_if(!tryexec1, "TryExec=%s wasn't found in $PATH", TEST_TRYEXEC);
+
+        /* Nothing changed, so both are hits */
+        fail_if(brisk_apps_info_cache_begin(cache), "Unchanged reload flushed the cache");
+        plain2 = brisk_apps_info_cache_lookup(cache, plain);
+        tryexec2 = brisk_apps_info_cache_lookup(cache, tryexec);
+        fail_if(plain2 != plain1, "Unchanged %s was parsed again", plain);
+        fail_if(tryexec2 != tryexec1, "Unchanged %s was parsed again", tryexec);
+
+        /* Touching one file only misses that file */
+        test_write(plain,
+                   "[Desktop Entry]\nType=Application\nName=Plainer\nExec=true\n",
+                   0644);
+        fail_if(brisk_apps_info_cache_begin(cache), "Changed desktop file flushed the cache");
+        plain3 = brisk_apps_info_cache_lookup(cache, plain);
+        tryexec3 = brisk_apps_info_cache_lookup(cache, tryexec);
+        fail_if(!plain3 || plain3 == plain2, "Changed %s came from the cache", plain);
+        fail_if(!g_str_equal(g_app_info_get_name(G_APP_INFO(plain3)), "Plainer"),
+                "Changed %s has the old name",
+                plain);
+        fail_if(tryexec3 != tryexec1, "Unchanged %s was parsed again", tryexec);
+
+        /* Losing the exec bit leaves the $PATH directory alone, so only the
+         * entry relying on the binary misses */
+        fail_if(g_chmod(bin, 0644) != 0, "Failed to chmod %s", bin);
+        fail_if(brisk_apps_info_cache_begin(cache), "chmod -x flushed the cache");
+        plain4 = brisk_apps_info_cache_lookup(cache, plain);
+        tryexec4 = brisk_apps_info_cache_lookup(cache, tryexec);
+        fail_if(plain4 != plain3, "Unchanged %s was parsed again", plain);
+        fail_if(tryexec4 != NULL, "%s is still shown with TryExec not executable", tryexec);
+
+        /* And getting it back shows the entry again */
+        fail_if(g_chmod(bin, 0755) != 0, "Failed to chmod %s", bin);
+        fail_if(brisk_apps_info_cache_begin(cache), "chmod +x flushed the cache");
+        plain5 = brisk_apps_info_cache_lookup(cache, plain);
+        tryexec5 = brisk_apps_info_cache_lookup(cache, tryexec);
+        fail_if(plain5 != plain3, "Unchanged %s was parsed again", plain);
+        fail_if(!tryexec5, "%s is still hidden with TryExec executable", tryexec);
+
+        /* Removing the binary changes its $PATH directory, flushing everything */
+        fail_if(g_unlink(bin) != 0, "Failed to remove %s", bin);
+        fail_if(!brisk_apps_info_cache_begin(cache), "$PATH change didn't flush the cache");
+        plain6 = brisk_apps_info_cache_lookup(cache, plain);
+        tryexec6 = brisk_apps_info_cache_lookup(cache, tryexec);
+        fail_if(!plain6 || plain6 == plain3, "%s survived a $PATH change", plain);
+        fail_if(tryexec6 != NULL, "%s is still shown without its TryExec", tryexec);
+
+        brisk_apps_info_cache_free(cache);
+        g_unlink(plain);
+        g_unlink(tryexec);
+        g_rmdir(bindir);
+        g_rmdir(dir);
 }
 
 int main(__brisk_unused__ int argc, __brisk_unused__ char **argv)
 {
         GMainLoop *loop = NULL;
+        BriskFixture *fixture = NULL;
+        BriskFixtureConfig config = { 0 };
         autofree(BriskBackend) *backend = NULL;
+
+        /* Must happen before GLib caches the XDG directories */
+        brisk_fixture_config_init(&config);
+        config.n_entries = TEST_N_ENTRIES;
+        config.n_sections = TEST_N_SECTIONS;
+        config.n_actions = TEST_N_ACTIONS;
+        config.n_external = TEST_N_EXTERNAL;
+        fixture = brisk_fixture_new_full(&config, NULL);
+        brisk_fixture_export(fixture);
+
         backend = brisk_apps_backend_new();
         fail_if(backend == NULL, "Failed to construct apps backend");
 
@@ -93,6 +320,12 @@ int main(__brisk_unused__ int argc, __brisk_unused__ char **argv)
         run_apps_backend_test(backend, loop);
         g_main_loop_run(loop);
         g_main_loop_unref(loop);
+
+        g_clear_object(&backend);
+        brisk_fixture_free(fixture);
+
+        run_info_cache_test();
+        return EXIT_SUCCESS;
 }
 
 /*
@@ -0,0 +1,321 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "backend/favourites/favourites-backend.h"
+#include "brisk-resources.h"
+#include "fixture.h"
+#include "frontend/classic/classic-window.h"
+#include "menu-private.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+#include <gdk/gdkx.h>
+#include <gtk/gtk.h>
+BRISK_END_PEDANTIC
+
+/**
+ * Size of the synthetic catalog, only the first two entries are pinned
+ */
+#define TEST_N_ENTRIES 20
+#define TEST_N_SECTIONS 2
+
+#define TEST_FIRST "brisk-fixture-00000.desktop"
+#define TEST_SECOND "brisk-fixture-00001.desktop"
+
+/**
+ * Pointer motion is split into this many steps, so the drag threshold is
+ * crossed on the way rather than in one jump
+ */
+#define TEST_DRAG_STEPS 10
+
+/**
+ * Give up waiting on loads and grabs after this many seconds
+ */
+#define TEST_TIMEOUT 30
+
+/**
+ * How long a hide may take to arrive after the drop (ms)
+ */
+#define TEST_HIDE_WAIT 500
+
+DEF_AUTOFREE(char, free)
+DEF_AUTOFREE(GSettings, g_object_unref)
+DEF_AUTOFREE(GList, g_list_free)
+
+/**
+ * Mimic functionality from check library
+ */
+static inline void fail_if(bool b, const char *fmt, ...)
+{
+        va_list va;
+        autofree(char) *out = NULL;
+
+        if (!b) {
+                return;
+        }
+
+        va_start(va, fmt);
+
+        if (vasprintf(&out, fmt, va) < 0) {
+                fputs("Out of memory\n", stderr);
+                exit(1);
+        }
+
+        fprintf(stderr, " => error: %s\n", out);
+        va_end(va);
+        exit(1);
+}
+
+static void test_load_finished(__brisk_unused__ BriskBackend *backend,
+                               __brisk_unused__ const BriskBackendLoadStats *stats,
+                               gboolean *loaded)
+{
+        *loaded = TRUE;
+}
+
+/**
+ * Flush our fake input through the server and handle everything it caused
+ */
+static void test_settle(Display *xdisplay)
+{
+        GdkDisplay *display = gdk_display_get_default();
+
+        XSync(xdisplay, False);
+        gdk_display_sync(display);
+        while (g_main_context_iteration(NULL, FALSE)) {
+                ;
+        }
+        gdk_display_sync(display);
+}
+
+static gboolean test_quit(GMainLoop *loop)
+{
+        g_main_loop_quit(loop);
+        return G_SOURCE_REMOVE;
+}
+
+/**
+ * Let idle and timeout callbacks queued by the drop run
+ */
+static void test_wait(guint ms)
+{
+        GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+
+        g_timeout_add(ms, (GSourceFunc)test_quit, loop);
+        g_main_loop_run(loop);
+        g_main_loop_unref(loop);
+}
+
+/**
+ * Root window coordinates of the middle of the widget
+ */
+static void test_center(GtkWidget *widget, gint *x, gint *y)
+{
+        GtkWidget *toplevel = gtk_widget_get_toplevel(widget);
+        GtkAllocation alloc = { 0 };
+        gint origin_x = 0;
+        gint origin_y = 0;
+
+        gtk_widget_get_allocation(widget, &alloc);
+        fail_if(!gtk_widget_translate_coordinates(widget,
+                                                  toplevel,
+                                                  alloc.width / 2,
+                                                  alloc.height / 2,
+                                                  x,
+                                                  y),
+                "Widget isn't inside its toplevel");
+        gdk_window_get_origin(gtk_widget_get_window(toplevel), &origin_x, &origin_y);
+        *x += origin_x;
+        *y += origin_y;
+}
+
+/**
+ * Press on one widget, move across to the other and let go, as a user would
+ */
+static void test_drag(Display *xdisplay, GtkWidget *from, GtkWidget *to)
+{
+        gint from_x = 0;
+        gint from_y = 0;
+        gint to_x = 0;
+        gint to_y = 0;
+
+        test_center(from, &from_x, &from_y);
+        test_center(to, &to_x, &to_y);
+
+        XTestFakeMotionEvent(xdisplay, -1, from_x, from_y, CurrentTime);
+        test_settle(xdisplay);
+        XTestFakeButtonEvent(xdisplay, 1, True, CurrentTime);
+        test_settle(xdisplay);
+
+        for (gint i = 1; i <= TEST_DRAG_STEPS; i++) {
+                XTestFakeMotionEvent(xdisplay,
+                                     -1,
+                                     from_x + (to_x - from_x) * i / TEST_DRAG_STEPS,
+                                     from_y + (to_y - from_y) * i / TEST_DRAG_STEPS,
+                                     CurrentTime);
+                test_settle(xdisplay);
+        }
+
+        XTestFakeButtonEvent(xdisplay, 1, False, CurrentTime);
+        test_settle(xdisplay);
+}
+
+/**
+ * The favourites category button, so that pinned items have a sort order
+ */
+static GtkWidget *test_favourites_section(BriskMenuWindow *window)
+{
+        GtkWidget *box = g_hash_table_lookup(window->section_boxes,
+                                             g_intern_static_string("favourites"));
+        autofree(GList) *kids = NULL;
+
+        fail_if(box == NULL, "Window has no favourites section box");
+        kids = gtk_container_get_children(GTK_CONTAINER(box));
+        for (GList *elem = kids; elem; elem = elem->next) {
+                if (GTK_IS_RADIO_BUTTON(elem->data)) {
+                        return elem->data;
+                }
+        }
+        return NULL;
+}
+
+/**
+ * Dropping one favourite onto another reorders them, and the menu must stay
+ * open for the next one rather than hiding as any other drag end does
+ */
+static void test_reorder(Display *xdisplay)
+{
+        BriskFavouritesBackend *favourites = NULL;
+        const GPtrArray *pinned = NULL;
+        BriskMenuWindow *window = NULL;
+        BriskBackend *apps = NULL;
+        GtkWidget *parent = NULL;
+        GtkWidget *button = NULL;
+        GtkWidget *section = NULL;
+        GtkWidget *first = NULL;
+        GtkWidget *second = NULL;
+        gboolean loaded = FALSE;
+        gint64 deadline = 0;
+
+        parent = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        button = gtk_button_new_with_label("Menu");
+        gtk_container_add(GTK_CONTAINER(parent), button);
+        gtk_widget_show_all(parent);
+
+        window = brisk_classic_window_new(button);
+        apps = g_hash_table_lookup(window->backends, g_intern_static_string("apps"));
+        fail_if(apps == NULL, "Window has no apps backend");
+        g_signal_connect(apps, "load-finished", G_CALLBACK(test_load_finished), &loaded);
+        favourites = BRISK_FAVOURITES_BACKEND(
+            g_hash_table_lookup(window->backends, g_intern_static_string("favourites")));
+
+        brisk_menu_window_load_menus(window);
+        brisk_menu_window_pump_settings(window);
+
+        deadline = g_get_monotonic_time() + TEST_TIMEOUT * G_USEC_PER_SEC;
+        while (!loaded) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "Timed out loading");
+        }
+        test_settle(xdisplay);
+
+        section = test_favourites_section(window);
+        fail_if(section == NULL, "No favourites category button");
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(section), TRUE);
+
+        first = g_hash_table_lookup(window->item_store, g_intern_static_string(TEST_FIRST));
+        second = g_hash_table_lookup(window->item_store, g_intern_static_string(TEST_SECOND));
+        fail_if(!first || !second, "Pinned fixture entries weren't loaded");
+
+        brisk_menu_window_update_screen_position(window);
+        gtk_widget_show(GTK_WIDGET(window));
+        deadline = g_get_monotonic_time() + TEST_TIMEOUT * G_USEC_PER_SEC;
+        while (!window->grabbed) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "Menu never grabbed input");
+        }
+        test_settle(xdisplay);
+
+        test_drag(xdisplay, second, first);
+        test_wait(TEST_HIDE_WAIT);
+
+        pinned = brisk_favourites_backend_get_pinned(favourites);
+        fail_if(g_strcmp0(g_ptr_array_index(pinned, 0), TEST_SECOND) != 0,
+                "Dropping %s onto %s didn't reorder them",
+                TEST_SECOND,
+                TEST_FIRST);
+        fail_if(!gtk_widget_get_visible(GTK_WIDGET(window)), "Reordering hid the menu");
+
+        gtk_widget_hide(GTK_WIDGET(window));
+        gtk_widget_destroy(GTK_WIDGET(window));
+        gtk_widget_destroy(parent);
+        test_settle(xdisplay);
+}
+
+int main(int argc, char **argv)
+{
+        autofree(GSettings) *settings = NULL;
+        BriskFixture *fixture = NULL;
+        Display *xdisplay = NULL;
+        gint dummy = 0;
+
+        /* Must happen before GLib caches the XDG directories */
+        fixture = brisk_fixture_new(TEST_N_ENTRIES, TEST_N_SECTIONS);
+        brisk_fixture_export(fixture);
+
+        /* Let meson know we were skipped rather than failed */
+        if (!gtk_init_check(&argc, &argv)) {
+                fputs("No display available, skipping\n", stderr);
+                brisk_fixture_free(fixture);
+                return 77;
+        }
+
+        xdisplay = GDK_DISPLAY_XDISPLAY(gdk_display_get_default());
+        if (!XTestQueryExtension(xdisplay, &dummy, &dummy, &dummy, &dummy)) {
+                fputs("XTEST unavailable, skipping\n", stderr);
+                brisk_fixture_free(fixture);
+                return 77;
+        }
+
+        settings = g_settings_new("com.solus-project.brisk-menu");
+        g_settings_set_strv(settings,
+                            "favourites",
+                            (const gchar *[]){ TEST_FIRST, TEST_SECOND, NULL });
+
+        brisk_resources_register_resource();
+        test_reorder(xdisplay);
+        brisk_resources_unregister_resource();
+
+        brisk_fixture_free(fixture);
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,233 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "backend/favourites/favourites-backend.h"
+BRISK_END_PEDANTIC
+
+/**
+ * Long enough for the batched settings write to have gone out (ms)
+ */
+#define TEST_APPLY_WAIT 1500
+
+DEF_AUTOFREE(BriskBackend, g_object_unref)
+DEF_AUTOFREE(GSettings, g_object_unref)
+DEF_AUTOFREE(char, free)
+
+typedef gchar *gstrv;
+DEF_AUTOFREE(gstrv, g_strfreev)
+
+/**
+ * Mimic functionality from check library
+ */
+static inline void fail_if(bool b, const char *fmt, ...)
+{
+        va_list va;
+        autofree(char) *out = NULL;
+
+        if (!b) {
+                return;
+        }
+
+        va_start(va, fmt);
+
+        if (vasprintf(&out, fmt, va) < 0) {
+                fputs("Out of memory\n", stderr);
+                exit(1);
+        }
+
+        fprintf(stderr, " => error: %s\n", out);
+        va_end(va);
+        exit(1);
+}
+
+/**
+ * Every item-changed since the last check, by ID
+ */
+static GHashTable *changed = NULL;
+
+static void test_item_changed(__brisk_unused__ BriskBackend *backend, const gchar *id,
+                              __brisk_unused__ gpointer v)
+{
+        g_hash_table_add(changed, (gpointer)g_intern_string(id));
+}
+
+/**
+ * Exactly the given IDs, and nothing else, must have changed
+ */
+static void expect_changed(const gchar *what, const gchar *const *ids)
+{
+        guint n_ids = g_strv_length((gchar **)ids);
+
+        for (guint i = 0; i < n_ids; i++) {
+                fail_if(!g_hash_table_contains(changed, g_intern_string(ids[i])),
+                        "%s: expected item-changed for %s",
+                        what,
+                        ids[i]);
+        }
+        fail_if(g_hash_table_size(changed) != n_ids,
+                "%s: expected %u item-changed, got %u",
+                what,
+                n_ids,
+                g_hash_table_size(changed));
+
+        g_hash_table_remove_all(changed);
+}
+
+/**
+ * The store must hold exactly these IDs, in this order
+ */
+static void expect_order(BriskFavouritesBackend *self, const gchar *const *ids)
+{
+        guint n_ids = g_strv_length((gchar **)ids);
+        gpointer val = NULL;
+
+        fail_if(self->favourites_order->len != n_ids,
+                "Expected %u favourites, got %u",
+                n_ids,
+                self->favourites_order->len);
+
+        for (guint i = 0; i < n_ids; i++) {
+                const gchar *id = g_intern_string(ids[i]);
+                fail_if(g_ptr_array_index(self->favourites_order, i) != id,
+                        "Expected %s at %u",
+                        id,
+                        i);
+                fail_if(!g_hash_table_lookup_extended(self->favourites, id, NULL, &val) ||
+                            GPOINTER_TO_UINT(val) != i,
+                        "Stale position for %s",
+                        id);
+        }
+}
+
+/**
+ * What another process would currently read from GSettings
+ */
+static void expect_stored(GSettings *settings, const gchar *const *ids)
+{
+        autofree(gstrv) *favs = g_settings_get_strv(settings, "favourites");
+        guint n_ids = g_strv_length((gchar **)ids);
+
+        fail_if(g_strv_length(favs) != n_ids,
+                "Expected %u stored favourites, got %u",
+                n_ids,
+                g_strv_length(favs));
+        for (guint i = 0; i < n_ids; i++) {
+                fail_if(!g_str_equal(favs[i], ids[i]), "Expected %s stored at %u", ids[i], i);
+        }
+}
+
+static gboolean test_quit(GMainLoop *loop)
+{
+        g_main_loop_quit(loop);
+        return G_SOURCE_REMOVE;
+}
+
+static void wait_for_apply(void)
+{
+        GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+
+        g_timeout_add(TEST_APPLY_WAIT, (GSourceFunc)test_quit, loop);
+        g_main_loop_run(loop);
+        g_main_loop_unref(loop);
+}
+
+int main(__brisk_unused__ int argc, __brisk_unused__ char **argv)
+{
+        autofree(BriskBackend) *backend = NULL;
+        autofree(GSettings) *settings = NULL;
+        BriskFavouritesBackend *self = NULL;
+        const gchar *none[] = { NULL };
+
+        changed = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+        /* Our view of the settings, as anyone else would see them */
+        settings = g_settings_new("com.solus-project.brisk-menu");
+        g_settings_set_strv(settings, "favourites", none);
+
+        backend = brisk_favourites_backend_new();
+        self = BRISK_FAVOURITES_BACKEND(backend);
+        g_signal_connect(backend, "item-changed", G_CALLBACK(test_item_changed), NULL);
+        expect_order(self, none);
+
+        /* Pinning touches the pinned item and anything it pushed along */
+        fail_if(!brisk_favourites_backend_insert(self, "a.desktop", -1), "Failed to pin a");
+        fail_if(!brisk_favourites_backend_insert(self, "b.desktop", -1), "Failed to pin b");
+        expect_changed("append", (const gchar *[]){ "a.desktop", "b.desktop", NULL });
+        fail_if(!brisk_favourites_backend_insert(self, "c.desktop", 1), "Failed to pin c");
+        fail_if(brisk_favourites_backend_insert(self, "a.desktop", -1), "Pinned a twice");
+        expect_changed("insert", (const gchar *[]){ "b.desktop", "c.desktop", NULL });
+        fail_if(!brisk_favourites_backend_insert(self, "d.desktop", -1), "Failed to pin d");
+        expect_changed("append", (const gchar *[]){ "d.desktop", NULL });
+        expect_order(self,
+                     (const gchar *[]){ "a.desktop", "c.desktop", "b.desktop", "d.desktop", NULL });
+
+        /* Moving only shifts the items between the two positions */
+        fail_if(!brisk_favourites_backend_move(self, "b.desktop", 0), "Failed to move b");
+        fail_if(brisk_favourites_backend_move(self, "b.desktop", 0), "Moved b nowhere");
+        expect_changed("move", (const gchar *[]){ "a.desktop", "b.desktop", "c.desktop", NULL });
+        expect_order(self,
+                     (const gchar *[]){ "b.desktop", "a.desktop", "c.desktop", "d.desktop", NULL });
+
+        fail_if(!brisk_favourites_backend_remove(self, "a.desktop"), "Failed to unpin a");
+        fail_if(brisk_favourites_backend_remove(self, "a.desktop"), "Unpinned a twice");
+        expect_changed("remove", (const gchar *[]){ "a.desktop", "c.desktop", "d.desktop", NULL });
+        expect_order(self, (const gchar *[]){ "b.desktop", "c.desktop", "d.desktop", NULL });
+
+        /* None of that has been written yet, and then it all goes at once */
+        expect_stored(settings, none);
+        wait_for_apply();
+        expect_stored(settings, (const gchar *[]){ "b.desktop", "c.desktop", "d.desktop", NULL });
+        expect_changed("apply", none);
+
+        /* Writing back what we already have is a no-op */
+        g_settings_set_strv(settings,
+                            "favourites",
+                            (const gchar *[]){ "b.desktop", "c.desktop", "d.desktop", NULL });
+        wait_for_apply();
+        expect_changed("same", none);
+        expect_order(self, (const gchar *[]){ "b.desktop", "c.desktop", "d.desktop", NULL });
+
+        /* Changes from elsewhere only notify what actually differs */
+        g_settings_set_strv(settings,
+                            "favourites",
+                            (const gchar *[]){ "c.desktop", "d.desktop", NULL });
+        wait_for_apply();
+        expect_changed("external",
+                       (const gchar *[]){ "b.desktop", "c.desktop", "d.desktop", NULL });
+        expect_order(self, (const gchar *[]){ "c.desktop", "d.desktop", NULL });
+
+        g_clear_object(&backend);
+        g_hash_table_unref(changed);
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,380 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "brisk-resources.h"
+#include "frontend/classic/classic-window.h"
+#include "key-binder.h"
+#include "menu-private.h"
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+#include <X11/keysym.h>
+#include <gdk/gdkx.h>
+#include <gtk/gtk.h>
+BRISK_END_PEDANTIC
+
+/**
+ * Bindings held alongside Super_L, which used to each cost a resend
+ */
+static const gchar *test_shortcuts[] = {
+        "<Control><Alt>F1", "<Control><Alt>F2",  "<Control><Alt>F3",  "<Control><Alt>F4",
+        "<Control><Alt>F5", "<Control><Alt>F6",  "<Control><Alt>F7",  "<Control><Alt>F8",
+        "<Control><Alt>F9", "<Control><Alt>F10", "<Control><Alt>F11", "<Control><Alt>F12",
+};
+
+/**
+ * Number of Super_L taps to time
+ */
+#define TEST_N_TAPS 200
+
+/**
+ * Mean time the binder may spend on each key event (µs). A wall clock this
+ * fine is too noisy on shared machines to fail on by default, so it is only
+ * enforced when BRISK_TEST_BUDGET_SCALE is set, and otherwise just reported.
+ */
+#define TEST_BUDGET_EVENT 20.0
+
+/**
+ * Give up waiting on the menu's grab after this many seconds
+ */
+#define TEST_TIMEOUT 5
+
+DEF_AUTOFREE(char, free)
+DEF_AUTOFREE(GSettings, g_object_unref)
+
+/**
+ * Mimic functionality from check library
+ */
+static inline void fail_if(bool b, const char *fmt, ...)
+{
+        va_list va;
+        autofree(char) *out = NULL;
+
+        if (!b) {
+                return;
+        }
+
+        va_start(va, fmt);
+
+        if (vasprintf(&out, fmt, va) < 0) {
+                fputs("Out of memory\n", stderr);
+                exit(1);
+        }
+
+        fprintf(stderr, " => error: %s\n", out);
+        va_end(va);
+        exit(1);
+}
+
+/**
+ * What the binder has done so far. Our own filters sit either side of the
+ * binder's on the root window, so the time between them is its alone.
+ */
+typedef struct TestState {
+        guint activated;  /**<Times the Super_L binding fired */
+        guint events;     /**<Key events the binder has seen */
+        gint64 start;     /**<When the current event reached the binder (ns) */
+        gint64 spent;     /**<Total time spent in the binder (ns) */
+        Display *spy;     /**<Our own connection, for faking keys and watching resends */
+        guint resends;    /**<Synthetic key events seen on the root window */
+} TestState;
+
+static gint64 test_now(void)
+{
+        struct timespec ts = { 0 };
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (gint64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static gboolean test_is_key(XEvent *xev)
+{
+        return xev->type == KeyPress || xev->type == KeyRelease;
+}
+
+static GdkFilterReturn test_filter_before(GdkXEvent *xevent, __brisk_unused__ GdkEvent *event,
+                                          TestState *state)
+{
+        if (test_is_key(xevent) && !((XEvent *)xevent)->xkey.send_event) {
+                state->start = test_now();
+        }
+        return GDK_FILTER_CONTINUE;
+}
+
+static GdkFilterReturn test_filter_after(GdkXEvent *xevent, __brisk_unused__ GdkEvent *event,
+                                         TestState *state)
+{
+        if (test_is_key(xevent) && !((XEvent *)xevent)->xkey.send_event) {
+                state->spent += test_now() - state->start;
+                ++state->events;
+        }
+        return GDK_FILTER_CONTINUE;
+}
+
+static void test_activated(__brisk_unused__ GdkEvent *event, TestState *state)
+{
+        ++state->activated;
+}
+
+static void test_key(TestState *state, KeySym keysym, gboolean press)
+{
+        XTestFakeKeyEvent(state->spy, XKeysymToKeycode(state->spy, keysym), press, CurrentTime);
+}
+
+/**
+ * Wait until the server has delivered everything we faked, the binder has
+ * handled it, and anything it re-sent has come back round to us
+ */
+static void test_settle(TestState *state)
+{
+        GdkDisplay *display = gdk_display_get_default();
+
+        XSync(state->spy, False);
+        gdk_display_sync(display);
+        while (g_main_context_iteration(NULL, FALSE)) {
+                ;
+        }
+        gdk_display_sync(display);
+        XSync(state->spy, False);
+
+        while (XPending(state->spy) > 0) {
+                XEvent xev = { 0 };
+                XNextEvent(state->spy, &xev);
+                if (test_is_key(&xev) && xev.xkey.send_event) {
+                        ++state->resends;
+                }
+        }
+}
+
+/**
+ * With a raw Super_L hotkey, tapping it while the menu is open and holds the
+ * keyboard must close it, and the next tap open it again
+ */
+static void test_menu_raw(TestState *state)
+{
+        autofree(GSettings) *settings = g_settings_new("com.solus-project.brisk-menu");
+        BriskMenuWindow *window = NULL;
+        GtkWidget *parent = NULL;
+        GtkWidget *button = NULL;
+        gint64 deadline = 0;
+
+        g_settings_set_string(settings, "hot-key", "Super_L");
+        g_settings_set_boolean(settings, "hot-key-raw", TRUE);
+
+        parent = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        button = gtk_button_new_with_label("Menu");
+        gtk_container_add(GTK_CONTAINER(parent), button);
+        gtk_widget_show_all(parent);
+
+        window = brisk_classic_window_new(button);
+        brisk_menu_window_pump_settings(window);
+        test_settle(state);
+
+        if (!brisk_key_binder_is_raw(window->binder, "Super_L")) {
+                g_message("keybinder: XInput2 unavailable, not testing raw menu hotkey");
+                goto end;
+        }
+
+        brisk_menu_window_update_screen_position(window);
+        gtk_widget_show(GTK_WIDGET(window));
+        deadline = g_get_monotonic_time() + TEST_TIMEOUT * G_USEC_PER_SEC;
+        while (!window->grabbed) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "Menu never grabbed the keyboard");
+        }
+        test_settle(state);
+
+        test_key(state, XK_Super_L, TRUE);
+        test_key(state, XK_Super_L, FALSE);
+        test_settle(state);
+        fail_if(gtk_widget_get_visible(GTK_WIDGET(window)),
+                "Raw Super_L tap didn't close the menu");
+
+        test_key(state, XK_Super_L, TRUE);
+        test_key(state, XK_Super_L, FALSE);
+        test_settle(state);
+        fail_if(!gtk_widget_get_visible(GTK_WIDGET(window)),
+                "Raw Super_L tap didn't open the menu");
+
+        gtk_widget_hide(GTK_WIDGET(window));
+end:
+        gtk_widget_destroy(GTK_WIDGET(window));
+        gtk_widget_destroy(parent);
+        test_settle(state);
+}
+
+/**
+ * Returns 0 when the budget shouldn't be enforced
+ */
+static gdouble test_budget_scale(void)
+{
+        const gchar *scale = g_getenv("BRISK_TEST_BUDGET_SCALE");
+
+        if (!scale) {
+                return 0.0;
+        }
+        return MAX(g_ascii_strtod(scale, NULL), 1.0);
+}
+
+int main(int argc, char **argv)
+{
+        BriskKeyBinder *binder = NULL;
+        GdkWindow *root = NULL;
+        TestState state = { 0 };
+        gint dummy = 0;
+        guint events = 0;
+        gdouble mean = 0.0;
+        gdouble scale = test_budget_scale();
+
+        /* Let meson know we were skipped rather than failed */
+        if (!gtk_init_check(&argc, &argv)) {
+                fputs("No display available, skipping\n", stderr);
+                return 77;
+        }
+
+        state.spy = XOpenDisplay(gdk_display_get_name(gdk_display_get_default()));
+        if (!state.spy || !XTestQueryExtension(state.spy, &dummy, &dummy, &dummy, &dummy)) {
+                fputs("XTEST unavailable, skipping\n", stderr);
+                return 77;
+        }
+
+        root = gdk_get_default_root_window();
+        XSelectInput(state.spy,
+                     DefaultRootWindow(state.spy),
+                     KeyPressMask | KeyReleaseMask);
+
+        /* Filters run in the order added, so the binder's lands in between */
+        gdk_window_add_filter(root, (GdkFilterFunc)test_filter_before, &state);
+        binder = brisk_key_binder_new();
+        gdk_window_add_filter(root, (GdkFilterFunc)test_filter_after, &state);
+
+        fail_if(!brisk_key_binder_bind(binder, "Super_L", (BinderFunc)test_activated, &state),
+                "Failed to bind Super_L");
+        for (guint i = 0; i < G_N_ELEMENTS(test_shortcuts); i++) {
+                fail_if(!brisk_key_binder_bind(binder,
+                                               test_shortcuts[i],
+                                               (BinderFunc)test_activated,
+                                               &state),
+                        "Failed to bind %s",
+                        test_shortcuts[i]);
+        }
+        test_settle(&state);
+
+        /* A plain tap activates, and is never passed on */
+        for (guint i = 0; i < TEST_N_TAPS; i++) {
+                test_key(&state, XK_Super_L, TRUE);
+                test_key(&state, XK_Super_L, FALSE);
+        }
+        test_settle(&state);
+
+        fail_if(state.activated != TEST_N_TAPS,
+                "Expected %u activations, got %u",
+                TEST_N_TAPS,
+                state.activated);
+        fail_if(state.resends != 0, "Taps caused %u resends", state.resends);
+
+        mean = (gdouble)state.spent / (gdouble)MAX(state.events, 1) / 1000.0;
+        g_message("keybinder: %u events, mean %.2fµs per event (budget %.2fµs%s)",
+                  state.events,
+                  mean,
+                  TEST_BUDGET_EVENT * MAX(scale, 1.0),
+                  scale > 0.0 ? "" : ", not enforced");
+        fail_if(scale > 0.0 && mean > TEST_BUDGET_EVENT * scale,
+                "Mean of %.2fµs per event exceeds budget of %.2fµs",
+                mean,
+                TEST_BUDGET_EVENT * scale);
+
+        /* Super+a is someone else's shortcut: no activation, and each event
+         * we saw after the Super press is passed on exactly once */
+        state.activated = 0;
+        events = state.events;
+        test_key(&state, XK_Super_L, TRUE);
+        test_key(&state, XK_a, TRUE);
+        test_key(&state, XK_a, FALSE);
+        test_key(&state, XK_Super_L, FALSE);
+        test_settle(&state);
+
+        events = state.events - events;
+        fail_if(state.activated != 0, "Super+a activated the binding");
+        fail_if(state.resends == 0, "Super+a was never passed on");
+        fail_if(state.resends > events - 1,
+                "Super+a caused %u resends for %u events",
+                state.resends,
+                events - 1);
+
+        /* Unbinding takes it out of the index too */
+        fail_if(!brisk_key_binder_unbind(binder, "Super_L"), "Failed to unbind Super_L");
+        test_key(&state, XK_Super_L, TRUE);
+        test_key(&state, XK_Super_L, FALSE);
+        test_settle(&state);
+        fail_if(state.activated != 0, "Super_L activated after unbinding");
+
+        /* Raw mode sees the same taps and chords without grabbing Super_L */
+        if (brisk_key_binder_set_mode(binder, BRISK_KEY_BINDER_MODE_RAW)) {
+                fail_if(!brisk_key_binder_bind(binder,
+                                               "Super_L",
+                                               (BinderFunc)test_activated,
+                                               &state),
+                        "Failed to bind Super_L in raw mode");
+                test_settle(&state);
+                state.resends = 0;
+
+                test_key(&state, XK_Super_L, TRUE);
+                test_key(&state, XK_Super_L, FALSE);
+                test_settle(&state);
+                fail_if(state.activated != 1, "Raw Super_L tap didn't activate");
+
+                test_key(&state, XK_Super_L, TRUE);
+                test_key(&state, XK_a, TRUE);
+                test_key(&state, XK_a, FALSE);
+                test_key(&state, XK_Super_L, FALSE);
+                test_settle(&state);
+                fail_if(state.activated != 1, "Raw Super+a activated the binding");
+                fail_if(state.resends != 0, "Raw mode caused %u resends", state.resends);
+        } else {
+                g_message("keybinder: XInput2 unavailable, not testing raw mode");
+        }
+
+        g_object_unref(binder);
+        test_settle(&state);
+
+        brisk_resources_register_resource();
+        test_menu_raw(&state);
+        brisk_resources_unregister_resource();
+
+        gdk_window_remove_filter(root, (GdkFilterFunc)test_filter_before, &state);
+        gdk_window_remove_filter(root, (GdkFilterFunc)test_filter_after, &state);
+        XCloseDisplay(state.spy);
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,421 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "brisk-resources.h"
+#include "frontend/classic/classic-window.h"
+#include "menu-private.h"
+#include <gtk/gtk.h>
+BRISK_END_PEDANTIC
+
+/**
+ * How long our stand-in services sit on each reply, in milliseconds
+ */
+#define TEST_REPLY_DELAY 750
+
+/**
+ * The main loop is sampled at this interval (ms) while replies are pending,
+ * and must never go longer than TEST_MAX_STALL (ms) between samples. Any
+ * synchronous call would stall for at least TEST_REPLY_DELAY.
+ */
+#define TEST_TICK 5
+#define TEST_MAX_STALL 250
+
+/**
+ * Give up waiting on replies after this many seconds
+ */
+#define TEST_TIMEOUT 30
+
+DEF_AUTOFREE(char, free)
+
+/**
+ * Mimic functionality from check library
+ */
+static inline void fail_if(bool b, const char *fmt, ...)
+{
+        va_list va;
+        autofree(char) *out = NULL;
+
+        if (!b) {
+                return;
+        }
+
+        va_start(va, fmt);
+
+        if (vasprintf(&out, fmt, va) < 0) {
+                fputs("Out of memory\n", stderr);
+                exit(1);
+        }
+
+        fprintf(stderr, " => error: %s\n", out);
+        va_end(va);
+        exit(1);
+}
+
+/**
+ * Stand-in for org.gnome.SessionManager and org.mate.ScreenSaver
+ */
+typedef struct TestServices {
+        GDBusConnection *conn;
+        GnomeSessionManager *session;
+        MateScreenSaver *saver;
+        guint session_owner;
+        guint saver_owner;
+        guint n_owned;
+        guint n_replies;
+        gboolean can_shutdown; /**<What CanShutdown answers with */
+} TestServices;
+
+/**
+ * A reply the stand-in service is sitting on
+ */
+typedef struct TestReply {
+        TestServices *services;
+        GObject *skeleton;
+        GDBusMethodInvocation *invocation;
+} TestReply;
+
+/**
+ * Watches for the main loop going quiet while replies are pending
+ */
+typedef struct TestStall {
+        gint64 last;
+        gint64 longest;
+} TestStall;
+
+static gboolean test_reply_send(TestReply *reply)
+{
+        if (GNOME_IS_SESSION_MANAGER(reply->skeleton)) {
+                gnome_session_manager_complete_can_shutdown(GNOME_SESSION_MANAGER(reply->skeleton),
+                                                            reply->invocation,
+                                                            reply->services->can_shutdown);
+        } else {
+                mate_screen_saver_complete_get_active(MATE_SCREEN_SAVER(reply->skeleton),
+                                                      reply->invocation,
+                                                      FALSE);
+        }
+
+        ++reply->services->n_replies;
+        g_free(reply);
+        return G_SOURCE_REMOVE;
+}
+
+static gboolean test_reply_later(GObject *skeleton, GDBusMethodInvocation *invocation,
+                                 TestServices *services)
+{
+        TestReply *reply = g_new0(TestReply, 1);
+
+        reply->services = services;
+        reply->skeleton = skeleton;
+        reply->invocation = invocation;
+        g_timeout_add(TEST_REPLY_DELAY, (GSourceFunc)test_reply_send, reply);
+        return TRUE;
+}
+
+static void test_name_acquired(__brisk_unused__ GDBusConnection *conn,
+                               __brisk_unused__ const gchar *name, gpointer v)
+{
+        TestServices *services = v;
+
+        ++services->n_owned;
+}
+
+static void test_services_start(TestServices *services, gboolean can_shutdown)
+{
+        autofree(GError) *error = NULL;
+        gint64 deadline = 0;
+
+        services->can_shutdown = can_shutdown;
+        services->conn = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, &error);
+        fail_if(error != NULL, "Cannot connect to the test bus: %s", error ? error->message : "");
+
+        services->session = gnome_session_manager_skeleton_new();
+        g_signal_connect(services->session,
+                         "handle-can-shutdown",
+                         G_CALLBACK(test_reply_later),
+                         services);
+        g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(services->session),
+                                         services->conn,
+                                         "/org/gnome/SessionManager",
+                                         &error);
+        fail_if(error != NULL, "Cannot export SessionManager: %s", error ? error->message : "");
+
+        services->saver = mate_screen_saver_skeleton_new();
+        g_signal_connect(services->saver,
+                         "handle-get-active",
+                         G_CALLBACK(test_reply_later),
+                         services);
+        g_dbus_interface_skeleton_export(G_DBUS_INTERFACE_SKELETON(services->saver),
+                                         services->conn,
+                                         "/org/mate/ScreenSaver",
+                                         &error);
+        fail_if(error != NULL, "Cannot export ScreenSaver: %s", error ? error->message : "");
+
+        services->session_owner = g_bus_own_name_on_connection(services->conn,
+                                                               "org.gnome.SessionManager",
+                                                               G_BUS_NAME_OWNER_FLAGS_NONE,
+                                                               test_name_acquired,
+                                                               NULL,
+                                                               services,
+                                                               NULL);
+        services->saver_owner = g_bus_own_name_on_connection(services->conn,
+                                                             "org.mate.ScreenSaver",
+                                                             G_BUS_NAME_OWNER_FLAGS_NONE,
+                                                             test_name_acquired,
+                                                             NULL,
+                                                             services,
+                                                             NULL);
+
+        deadline = g_get_monotonic_time() + TEST_TIMEOUT * G_USEC_PER_SEC;
+        while (services->n_owned < 2) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "Timed out owning service names");
+        }
+}
+
+static void test_services_stop(TestServices *services)
+{
+        g_bus_unown_name(services->session_owner);
+        g_bus_unown_name(services->saver_owner);
+        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON(services->session));
+        g_dbus_interface_skeleton_unexport(G_DBUS_INTERFACE_SKELETON(services->saver));
+        g_clear_object(&services->session);
+        g_clear_object(&services->saver);
+        g_clear_object(&services->conn);
+}
+
+static gboolean test_stall_tick(TestStall *stall)
+{
+        gint64 now = g_get_monotonic_time();
+
+        stall->longest = MAX(stall->longest, now - stall->last);
+        stall->last = now;
+        return G_SOURCE_CONTINUE;
+}
+
+/**
+ * Construct a classic window and spin until its session setup has had all
+ * of its replies, returning how long the main loop was ever blocked for.
+ */
+static BriskMenuWindow *test_window_settle(GtkWidget *relative_to, gint64 *elapsed,
+                                           gint64 *longest)
+{
+        TestStall stall = { 0 };
+        BriskMenuWindow *window = NULL;
+        gint64 start = g_get_monotonic_time();
+        gint64 deadline = start + TEST_TIMEOUT * G_USEC_PER_SEC;
+        guint tick = 0;
+
+        stall.last = start;
+        tick = g_timeout_add(TEST_TICK, (GSourceFunc)test_stall_tick, &stall);
+
+        window = brisk_classic_window_new(relative_to);
+        fail_if(window == NULL, "Failed to construct window");
+
+        while (!window->session_cancellable || window->session_pending > 0) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "Timed out waiting on the session");
+        }
+
+        g_source_remove(tick);
+        test_stall_tick(&stall);
+
+        *elapsed = g_get_monotonic_time() - start;
+        *longest = stall.longest;
+        return window;
+}
+
+static void test_check_buttons(BriskMenuWindow *window, const char *name, gboolean logout,
+                               gboolean lock, gboolean shutdown)
+{
+        BriskClassicWindow *classic = BRISK_CLASSIC_WINDOW(window);
+
+        fail_if(window->can_logout != logout, "%s: can_logout should be %d", name, logout);
+        fail_if(window->can_lock != lock, "%s: can_lock should be %d", name, lock);
+        fail_if(window->can_shutdown != shutdown, "%s: can_shutdown should be %d", name, shutdown);
+        fail_if(gtk_widget_get_sensitive(classic->button_logout) != logout,
+                "%s: logout button sensitivity is wrong",
+                name);
+        fail_if(gtk_widget_get_sensitive(classic->button_lock) != lock,
+                "%s: lock button sensitivity is wrong",
+                name);
+        fail_if(gtk_widget_get_sensitive(classic->button_shutdown) != shutdown,
+                "%s: shutdown button sensitivity is wrong",
+                name);
+}
+
+static void test_drain(void)
+{
+        while (g_main_context_pending(NULL)) {
+                g_main_context_iteration(NULL, FALSE);
+        }
+}
+
+/**
+ * Neither service is on the bus, so everything stays insensitive
+ */
+static void test_session_absent(GtkWidget *relative_to)
+{
+        BriskMenuWindow *window = NULL;
+        gint64 elapsed = 0;
+        gint64 longest = 0;
+
+        window = test_window_settle(relative_to, &elapsed, &longest);
+        g_message("absent: settled in %" G_GINT64_FORMAT "us, longest stall %" G_GINT64_FORMAT "us",
+                  elapsed,
+                  longest);
+
+        fail_if(longest > TEST_MAX_STALL * 1000,
+                "absent: main loop stalled for %" G_GINT64_FORMAT "us",
+                longest);
+        test_check_buttons(window, "absent", FALSE, FALSE, FALSE);
+
+        gtk_widget_destroy(GTK_WIDGET(window));
+        test_drain();
+}
+
+/**
+ * Both services answer slowly; the main loop must keep running meanwhile
+ * and the buttons follow the replies once they land.
+ */
+static void test_session_slow(GtkWidget *relative_to, gboolean can_shutdown)
+{
+        TestServices services = { 0 };
+        BriskMenuWindow *window = NULL;
+        const char *name = can_shutdown ? "slow" : "slow-no-shutdown";
+        gint64 elapsed = 0;
+        gint64 longest = 0;
+
+        test_services_start(&services, can_shutdown);
+
+        window = test_window_settle(relative_to, &elapsed, &longest);
+        g_message("%s: settled in %" G_GINT64_FORMAT "us, longest stall %" G_GINT64_FORMAT "us",
+                  name,
+                  elapsed,
+                  longest);
+
+        fail_if(services.n_replies != 2,
+                "%s: expected 2 replies, got %u",
+                name,
+                services.n_replies);
+        fail_if(elapsed < TEST_REPLY_DELAY * 1000,
+                "%s: settled before the services replied",
+                name);
+        fail_if(longest > TEST_MAX_STALL * 1000,
+                "%s: main loop stalled for %" G_GINT64_FORMAT "us",
+                name,
+                longest);
+        test_check_buttons(window, name, TRUE, TRUE, can_shutdown);
+
+        gtk_widget_destroy(GTK_WIDGET(window));
+        test_drain();
+        test_services_stop(&services);
+        test_drain();
+}
+
+/**
+ * Destroying the window with replies outstanding must not touch it later
+ */
+static void test_session_cancel(GtkWidget *relative_to)
+{
+        TestServices services = { 0 };
+        BriskMenuWindow *window = NULL;
+        gint64 deadline = 0;
+
+        test_services_start(&services, TRUE);
+
+        window = brisk_classic_window_new(relative_to);
+        deadline = g_get_monotonic_time() + TEST_TIMEOUT * G_USEC_PER_SEC;
+        while (!window->session_cancellable) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "cancel: session setup never began");
+        }
+        gtk_widget_destroy(GTK_WIDGET(window));
+
+        while (services.n_replies < 2) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "cancel: services never replied");
+        }
+        test_drain();
+        test_services_stop(&services);
+        test_drain();
+}
+
+int main(int argc, char **argv)
+{
+        autofree(gchar) *daemon = NULL;
+        GTestDBus *bus = NULL;
+        GtkWidget *parent = NULL;
+        GtkWidget *button = NULL;
+
+        /* A private session bus we can populate with stand-in services */
+        daemon = g_find_program_in_path("dbus-daemon");
+        if (!daemon) {
+                fputs("No dbus-daemon available, skipping\n", stderr);
+                return 77;
+        }
+
+        /* Keep the accessibility bridge away from our private bus */
+        g_setenv("NO_AT_BRIDGE", "1", TRUE);
+
+        bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+        g_test_dbus_up(bus);
+
+        /* Let meson know we were skipped rather than failed */
+        if (!gtk_init_check(&argc, &argv)) {
+                fputs("No display available, skipping\n", stderr);
+                g_test_dbus_down(bus);
+                g_object_unref(bus);
+                return 77;
+        }
+
+        brisk_resources_register_resource();
+
+        parent = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        button = gtk_button_new_with_label("Menu");
+        gtk_container_add(GTK_CONTAINER(parent), button);
+        gtk_widget_show_all(parent);
+
+        test_session_absent(button);
+        test_session_slow(button, TRUE);
+        test_session_slow(button, FALSE);
+        test_session_cancel(button);
+
+        gtk_widget_destroy(parent);
+        test_drain();
+
+        brisk_resources_unregister_resource();
+        g_test_dbus_down(bus);
+        g_object_unref(bus);
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
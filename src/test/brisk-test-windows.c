@@ -0,0 +1,403 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "util.h"
+
+BRISK_BEGIN_PEDANTIC
+#include "brisk-resources.h"
+#include "fixture.h"
+#include "frontend/classic/classic-window.h"
+#include "frontend/dash/dash-window.h"
+#include "menu-private.h"
+#include <gtk/gtk.h>
+BRISK_END_PEDANTIC
+
+/**
+ * Size of the synthetic catalog each window is loaded with
+ */
+#define TEST_N_ENTRIES 2000
+#define TEST_N_SECTIONS 12
+
+/**
+ * Number of open/type/switch/close cycles per window. The first one is a
+ * warm up and is excluded from the allocation budget.
+ */
+#define TEST_N_CYCLES 20
+
+/**
+ * Typed one character at a time, every prefix matches some entries
+ */
+#define TEST_SEARCH "application 1"
+
+/**
+ * Budgets for the 90th percentile frame time of each action, in
+ * milliseconds. Slow machines may scale these with BRISK_TEST_BUDGET_SCALE.
+ */
+#define TEST_BUDGET_OPEN 500.0
+#define TEST_BUDGET_KEYSTROKE 150.0
+#define TEST_BUDGET_SECTION 150.0
+
+/**
+ * Heap growth allowed across all cycles after the warm up, catching leaks
+ * of widgets or items on every open/close.
+ */
+#define TEST_BUDGET_HEAP (2 * 1024 * 1024)
+
+/**
+ * Give up waiting on loads and frames after this many seconds
+ */
+#define TEST_TIMEOUT 30
+
+DEF_AUTOFREE(char, free)
+DEF_AUTOFREE(GArray, g_array_unref)
+DEF_AUTOFREE(GPtrArray, g_ptr_array_unref)
+
+/**
+ * Mimic functionality from check library
+ */
+static inline void fail_if(bool b, const char *fmt, ...)
+{
+        va_list va;
+        autofree(char) *out = NULL;
+
+        if (!b) {
+                return;
+        }
+
+        va_start(va, fmt);
+
+        if (vasprintf(&out, fmt, va) < 0) {
+                fputs("Out of memory\n", stderr);
+                exit(1);
+        }
+
+        fprintf(stderr, " => error: %s\n", out);
+        va_end(va);
+        exit(1);
+}
+
+/**
+ * Frame times for each scripted action
+ */
+typedef struct TestSamples {
+        GArray *open;
+        GArray *keystroke;
+        GArray *section;
+} TestSamples;
+
+typedef BriskMenuWindow *(*TestWindowFunc)(GtkWidget *relative_to);
+
+/**
+ * Bytes currently allocated from the heap, or 0 if we can't tell
+ */
+static gsize test_heap_in_use(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks;
+#elif defined(__GLIBC__)
+        struct mallinfo info = mallinfo();
+        return (gsize)info.uordblks;
+#else
+        return 0;
+#endif
+}
+
+static gdouble test_budget_scale(void)
+{
+        const gchar *scale = g_getenv("BRISK_TEST_BUDGET_SCALE");
+
+        if (!scale) {
+                return 1.0;
+        }
+        return MAX(g_ascii_strtod(scale, NULL), 1.0);
+}
+
+static void test_load_finished(__brisk_unused__ BriskBackend *backend,
+                               __brisk_unused__ const BriskBackendLoadStats *stats,
+                               gboolean *loaded)
+{
+        *loaded = TRUE;
+}
+
+static void test_after_paint(__brisk_unused__ GdkFrameClock *clock, gboolean *painted)
+{
+        *painted = TRUE;
+}
+
+/**
+ * Spin until the window has painted a frame, returning the milliseconds
+ * since @start
+ */
+static gdouble test_wait_frame(GtkWidget *window, gint64 start)
+{
+        GdkFrameClock *clock = gtk_widget_get_frame_clock(window);
+        gint64 deadline = start + TEST_TIMEOUT * G_USEC_PER_SEC;
+        gboolean painted = FALSE;
+        gulong id = 0;
+
+        fail_if(clock == NULL, "Window has no frame clock");
+
+        id = g_signal_connect(clock, "after-paint", G_CALLBACK(test_after_paint), &painted);
+        gdk_frame_clock_request_phase(clock, GDK_FRAME_CLOCK_PHASE_AFTER_PAINT);
+
+        while (!painted) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "Timed out waiting for a frame");
+        }
+
+        g_signal_handler_disconnect(clock, id);
+        return (gdouble)(g_get_monotonic_time() - start) / 1000.0;
+}
+
+static void test_drain(void)
+{
+        while (g_main_context_pending(NULL)) {
+                g_main_context_iteration(NULL, FALSE);
+        }
+}
+
+/**
+ * Every category button across all backends, used for switching sections
+ */
+static GPtrArray *test_collect_sections(BriskMenuWindow *window)
+{
+        GPtrArray *sections = g_ptr_array_new();
+        GHashTableIter iter;
+        gpointer box = NULL;
+
+        g_hash_table_iter_init(&iter, window->section_boxes);
+        while (g_hash_table_iter_next(&iter, NULL, &box)) {
+                autofree(GList) *kids = gtk_container_get_children(GTK_CONTAINER(box));
+                for (GList *elem = kids; elem; elem = elem->next) {
+                        if (GTK_IS_RADIO_BUTTON(elem->data)) {
+                                g_ptr_array_add(sections, elem->data);
+                        }
+                }
+        }
+
+        return sections;
+}
+
+/**
+ * One scripted interaction: open the menu, type a search, walk a section
+ * and close again
+ */
+static void test_cycle(BriskMenuWindow *window, GPtrArray *sections, guint cycle,
+                       TestSamples *samples)
+{
+        GtkWidget *widget = GTK_WIDGET(window);
+        gchar search[sizeof(TEST_SEARCH)] = { 0 };
+        GtkWidget *section = NULL;
+        gdouble elapsed = 0.0;
+        gint64 start = 0;
+
+        start = g_get_monotonic_time();
+        brisk_menu_window_update_screen_position(window);
+        gtk_widget_show(widget);
+        elapsed = test_wait_frame(widget, start);
+        g_array_append_val(samples->open, elapsed);
+
+        for (gsize i = 0; i < strlen(TEST_SEARCH); i++) {
+                search[i] = TEST_SEARCH[i];
+                start = g_get_monotonic_time();
+                gtk_entry_set_text(GTK_ENTRY(window->search), search);
+                elapsed = test_wait_frame(widget, start);
+                g_array_append_val(samples->keystroke, elapsed);
+        }
+        fail_if(g_strcmp0(window->search_term, TEST_SEARCH) != 0,
+                "Search term is '%s', expected '%s'",
+                window->search_term,
+                TEST_SEARCH);
+
+        /* Category buttons are insensitive while searching */
+        gtk_entry_set_text(GTK_ENTRY(window->search), "");
+        test_drain();
+
+        section = sections->pdata[cycle % sections->len];
+        start = g_get_monotonic_time();
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(section), TRUE);
+        elapsed = test_wait_frame(widget, start);
+        g_array_append_val(samples->section, elapsed);
+
+        gtk_widget_hide(widget);
+        test_drain();
+}
+
+static gint test_compare_double(gconstpointer a, gconstpointer b)
+{
+        gdouble da = *(const gdouble *)a;
+        gdouble db = *(const gdouble *)b;
+
+        return (da > db) - (da < db);
+}
+
+/**
+ * Check the 90th percentile of the samples against the budget
+ */
+static void test_check_budget(const gchar *type, const gchar *action, GArray *samples,
+                              gdouble budget)
+{
+        gdouble p50 = 0.0;
+        gdouble p90 = 0.0;
+
+        g_array_sort(samples, test_compare_double);
+        p50 = g_array_index(samples, gdouble, samples->len / 2);
+        p90 = g_array_index(samples, gdouble, (samples->len * 9) / 10);
+
+        g_message("%s: %s p50 %.2fms p90 %.2fms (budget %.2fms)",
+                  type,
+                  action,
+                  p50,
+                  p90,
+                  budget);
+
+        fail_if(p90 > budget,
+                "%s: %s p90 of %.2fms exceeds budget of %.2fms",
+                type,
+                action,
+                p90,
+                budget);
+}
+
+/**
+ * Construct a window of the given type, load the fixture catalog into it
+ * and run the scripted cycles against it
+ */
+static void test_window(const gchar *type, TestWindowFunc new_window)
+{
+        autofree(GPtrArray) *sections = NULL;
+        autofree(GArray) *open = g_array_new(FALSE, FALSE, sizeof(gdouble));
+        autofree(GArray) *keystroke = g_array_new(FALSE, FALSE, sizeof(gdouble));
+        autofree(GArray) *section = g_array_new(FALSE, FALSE, sizeof(gdouble));
+        TestSamples samples = { .open = open, .keystroke = keystroke, .section = section };
+        gdouble scale = test_budget_scale();
+        GtkWidget *parent = NULL;
+        GtkWidget *button = NULL;
+        BriskMenuWindow *window = NULL;
+        BriskBackend *apps = NULL;
+        gboolean loaded = FALSE;
+        gint64 deadline = 0;
+        gsize heap_start = 0;
+        gsize heap_end = 0;
+
+        /* Stand-in for the panel applet the menu is positioned against */
+        parent = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        button = gtk_button_new_with_label("Menu");
+        gtk_container_add(GTK_CONTAINER(parent), button);
+        gtk_widget_show_all(parent);
+
+        window = new_window(button);
+        fail_if(window == NULL, "%s: failed to construct window", type);
+
+        apps = g_hash_table_lookup(window->backends, g_intern_static_string("apps"));
+        fail_if(apps == NULL, "%s: window has no apps backend", type);
+        g_signal_connect(apps, "load-finished", G_CALLBACK(test_load_finished), &loaded);
+
+        brisk_menu_window_load_menus(window);
+        brisk_menu_window_pump_settings(window);
+
+        deadline = g_get_monotonic_time() + TEST_TIMEOUT * G_USEC_PER_SEC;
+        while (!loaded) {
+                g_main_context_iteration(NULL, TRUE);
+                fail_if(g_get_monotonic_time() > deadline, "%s: timed out loading", type);
+        }
+        test_drain();
+
+        fail_if(g_hash_table_size(window->item_store) < TEST_N_ENTRIES,
+                "%s: only %u entries in the window, expected at least %d",
+                type,
+                g_hash_table_size(window->item_store),
+                TEST_N_ENTRIES);
+
+        sections = test_collect_sections(window);
+        fail_if(sections->len < TEST_N_SECTIONS,
+                "%s: only %u section buttons, expected at least %d",
+                type,
+                sections->len,
+                TEST_N_SECTIONS);
+
+        for (guint i = 0; i < TEST_N_CYCLES; i++) {
+                test_cycle(window, sections, i, &samples);
+                if (i == 0) {
+                        heap_start = test_heap_in_use();
+                }
+        }
+        heap_end = test_heap_in_use();
+
+        test_check_budget(type, "open", open, TEST_BUDGET_OPEN * scale);
+        test_check_budget(type, "keystroke", keystroke, TEST_BUDGET_KEYSTROKE * scale);
+        test_check_budget(type, "section", section, TEST_BUDGET_SECTION * scale);
+
+        g_message("%s: heap grew by %" G_GSSIZE_FORMAT " bytes over %d cycles",
+                  type,
+                  (gssize)(heap_end - heap_start),
+                  TEST_N_CYCLES - 1);
+        fail_if(heap_end > heap_start && heap_end - heap_start > TEST_BUDGET_HEAP,
+                "%s: heap grew by %" G_GSIZE_FORMAT " bytes, budget is %d",
+                type,
+                heap_end - heap_start,
+                TEST_BUDGET_HEAP);
+
+        gtk_widget_destroy(GTK_WIDGET(window));
+        gtk_widget_destroy(parent);
+        test_drain();
+}
+
+int main(int argc, char **argv)
+{
+        BriskFixture *fixture = NULL;
+
+        /* Must happen before GLib caches the XDG directories */
+        fixture = brisk_fixture_new(TEST_N_ENTRIES, TEST_N_SECTIONS);
+        brisk_fixture_export(fixture);
+
+        /* Let meson know we were skipped rather than failed */
+        if (!gtk_init_check(&argc, &argv)) {
+                fputs("No display available, skipping\n", stderr);
+                brisk_fixture_free(fixture);
+                return 77;
+        }
+
+        brisk_resources_register_resource();
+
+        test_window("classic", brisk_classic_window_new);
+        test_window("dash", brisk_dash_window_new);
+
+        brisk_resources_unregister_resource();
+        brisk_fixture_free(fixture);
+        return EXIT_SUCCESS;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,452 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#define _GNU_SOURCE
+
+#include "util.h"
+
+#include <math.h>
+
+BRISK_BEGIN_PEDANTIC
+#include "fixture.h"
+#include <glib/gstdio.h>
+BRISK_END_PEDANTIC
+
+/**
+ * Every Nth entry is also placed into the nested settings menu
+ */
+#define FIXTURE_SETTINGS_STRIDE 25
+
+/**
+ * Every Nth entry also has a TryExec, which always succeeds
+ */
+#define FIXTURE_TRYEXEC_STRIDE 10
+
+#define FIXTURE_MENU_HEADER                                                                        \
+        "<!DOCTYPE Menu PUBLIC \"-//freedesktop//DTD Menu 1.0//EN\"\n"                             \
+        " \"http://www.freedesktop.org/standards/menu-spec/menu-1.0.dtd\">\n"
+
+DEF_AUTOFREE(gchar, g_free)
+DEF_AUTOFREE(gdouble, g_free)
+
+/**
+ * Write the file or abort, fixtures are useless when incomplete
+ */
+static void brisk_fixture_write(const gchar *dir, const gchar *name, const gchar *contents)
+{
+        autofree(gchar) *path = g_build_filename(dir, name, NULL);
+        GError *error = NULL;
+
+        if (!g_file_set_contents(path, contents, -1, &error)) {
+                g_error("Failed to write fixture %s: %s", path, error->message);
+        }
+}
+
+/**
+ * Create a directory inside the fixture root and return the path
+ */
+static gchar *brisk_fixture_mkdir(BriskFixture *self, const gchar *name)
+{
+        gchar *path = g_build_filename(self->root, name, NULL);
+
+        if (g_mkdir_with_parents(path, 00755) != 0) {
+                g_error("Failed to create fixture directory %s", path);
+        }
+        return path;
+}
+
+/**
+ * Words used when the config asks for Unicode content, covering accents,
+ * non-Latin scripts and characters outside of the BMP
+ */
+static const gchar *fixture_unicode_words[] = {
+        "Café",   "Über",   "Straße", "Ñandú",  "Ångström", "naïve",   "Ελληνικά",
+        "Ещё",    "日本語", "中文",   "한국어", "עברית",    "العربية", "🚀",
+};
+
+static const gchar *fixture_ascii_words[] = {
+        "editor", "viewer", "player",  "manager", "browser", "terminal", "monitor",
+        "office", "image",  "network", "system",  "archive", "calendar", "notes",
+};
+
+/**
+ * Locales written when the config asks for translations
+ */
+static const gchar *fixture_locales[] = {
+        "de", "fr", "es", "it", "pt_BR", "ru", "ja", "zh_CN", "ko", "el", "he", "ar", "sv", "pl",
+};
+
+static const gchar *brisk_fixture_word(BriskFixture *self, GRand *rand)
+{
+        if (self->config.unicode) {
+                return fixture_unicode_words[g_rand_int_range(rand,
+                                                              0,
+                                                              (gint32)G_N_ELEMENTS(
+                                                                  fixture_unicode_words))];
+        }
+        return fixture_ascii_words[g_rand_int_range(rand,
+                                                    0,
+                                                    (gint32)G_N_ELEMENTS(fixture_ascii_words))];
+}
+
+/**
+ * Pick the section for an entry. A skew of 0 simply assigns sections in turn,
+ * otherwise sections are weighted by 1/(k+1)^skew so that the first few
+ * categories hold most of the entries, as on a real system.
+ */
+static guint brisk_fixture_pick_section(BriskFixture *self, GRand *rand, const gdouble *cdf,
+                                        guint index)
+{
+        gdouble r = 0.0;
+
+        if (!cdf) {
+                return index % self->config.n_sections;
+        }
+
+        r = g_rand_double(rand);
+        for (guint i = 0; i < self->config.n_sections; i++) {
+                if (r < cdf[i]) {
+                        return i;
+                }
+        }
+        return self->config.n_sections - 1;
+}
+
+/**
+ * Cumulative distribution of the section weights, or NULL when uniform
+ */
+static gdouble *brisk_fixture_build_cdf(BriskFixture *self)
+{
+        gdouble *cdf = NULL;
+        gdouble total = 0.0;
+
+        if (self->config.skew <= 0.0) {
+                return NULL;
+        }
+
+        cdf = g_new0(gdouble, self->config.n_sections);
+        for (guint i = 0; i < self->config.n_sections; i++) {
+                total += 1.0 / pow(i + 1, self->config.skew);
+                cdf[i] = total;
+        }
+        for (guint i = 0; i < self->config.n_sections; i++) {
+                cdf[i] /= total;
+        }
+        return cdf;
+}
+
+static void brisk_fixture_write_entries(BriskFixture *self, const gchar *dir)
+{
+        GRand *rand = g_rand_new_with_seed(self->config.seed);
+        autofree(gdouble) *cdf = brisk_fixture_build_cdf(self);
+        guint n_locales = MIN(self->config.n_locales, G_N_ELEMENTS(fixture_locales));
+
+        for (guint i = 0; i < self->config.n_entries; i++) {
+                autofree(gchar) *name = g_strdup_printf("brisk-fixture-%05u.desktop", i);
+                const gchar *word = brisk_fixture_word(self, rand);
+                guint section = brisk_fixture_pick_section(self, rand, cdf, i);
+                GString *contents = g_string_new("[Desktop Entry]\nType=Application\n");
+
+                g_string_append_printf(contents, "Name=Fixture Application %u %s\n", i, word);
+                g_string_append_printf(contents, "GenericName=Fixture Tool %u\n", i);
+                g_string_append_printf(contents,
+                                       "Comment=Synthetic entry %u for section %u\n",
+                                       i,
+                                       section);
+
+                for (guint l = 0; l < n_locales; l++) {
+                        g_string_append_printf(contents,
+                                               "Name[%s]=%s %u %s\n"
+                                               "Comment[%s]=%s %u\n",
+                                               fixture_locales[l],
+                                               fixture_locales[l],
+                                               i,
+                                               word,
+                                               fixture_locales[l],
+                                               fixture_locales[l],
+                                               i);
+                }
+
+                g_string_append_printf(contents, "Keywords=fixture;synthetic;entry%u;", i);
+                for (guint k = 0; k < self->config.n_keywords; k++) {
+                        g_string_append_printf(contents, "%s;", brisk_fixture_word(self, rand));
+                }
+
+                g_string_append_printf(contents,
+                                       "\n%sExec=true\n"
+                                       "Icon=application-x-executable\n"
+                                       "Categories=BriskFixture%u;%s\n",
+                                       i % FIXTURE_TRYEXEC_STRIDE == 0 ? "TryExec=true\n" : "",
+                                       section,
+                                       i % FIXTURE_SETTINGS_STRIDE == 0 ? "BriskFixtureSettings;"
+                                                                        : "");
+
+                if (self->config.n_actions > 0) {
+                        g_string_append(contents, "Actions=");
+                        for (guint a = 0; a < self->config.n_actions; a++) {
+                                g_string_append_printf(contents, "fixture-action-%u;", a);
+                        }
+                        g_string_append_c(contents, '\n');
+                }
+                for (guint a = 0; a < self->config.n_actions; a++) {
+                        g_string_append_printf(contents,
+                                               "\n[Desktop Action fixture-action-%u]\n"
+                                               "Name=Fixture Action %u\n"
+                                               "Exec=true\n",
+                                               a,
+                                               a);
+                }
+
+                brisk_fixture_write(dir, name, contents->str);
+                g_string_free(contents, TRUE);
+        }
+
+        g_rand_free(rand);
+}
+
+/**
+ * These live outside the data dirs and only reach the menu via an <AppDir>
+ */
+static void brisk_fixture_write_external(BriskFixture *self, const gchar *dir)
+{
+        for (guint i = 0; i < self->config.n_external; i++) {
+                autofree(gchar) *name = g_strdup_printf("brisk-external-%05u.desktop", i);
+                autofree(gchar) *contents = NULL;
+
+                contents = g_strdup_printf(
+                    "[Desktop Entry]\n"
+                    "Type=Application\n"
+                    "Name=External Application %u\n"
+                    "Exec=true\n"
+                    "Icon=application-x-executable\n"
+                    "Categories=BriskFixtureExternal;\n",
+                    i);
+                brisk_fixture_write(dir, name, contents);
+        }
+}
+
+static void brisk_fixture_write_directories(BriskFixture *self, const gchar *dir)
+{
+        for (guint i = 0; i < self->config.n_sections; i++) {
+                autofree(gchar) *name = g_strdup_printf("brisk-fixture-%u.directory", i);
+                autofree(gchar) *contents = NULL;
+
+                contents = g_strdup_printf(
+                    "[Desktop Entry]\n"
+                    "Type=Directory\n"
+                    "Name=Fixture Section %u\n"
+                    "Icon=applications-other\n",
+                    i);
+                brisk_fixture_write(dir, name, contents);
+        }
+
+        brisk_fixture_write(dir,
+                            "brisk-fixture-settings.directory",
+                            "[Desktop Entry]\n"
+                            "Type=Directory\n"
+                            "Name=Fixture Settings\n"
+                            "Icon=preferences-system\n");
+        brisk_fixture_write(dir,
+                            "brisk-external.directory",
+                            "[Desktop Entry]\n"
+                            "Type=Directory\n"
+                            "Name=Fixture External\n"
+                            "Icon=applications-other\n");
+}
+
+static void brisk_fixture_write_menus(BriskFixture *self, const gchar *dir)
+{
+        GString *apps = g_string_new(FIXTURE_MENU_HEADER);
+
+        g_string_append(apps,
+                        "<Menu>\n"
+                        "  <Name>Applications</Name>\n"
+                        "  <DefaultAppDirs/>\n"
+                        "  <DefaultDirectoryDirs/>\n");
+        for (guint i = 0; i < self->config.n_sections; i++) {
+                g_string_append_printf(apps,
+                                       "  <Menu>\n"
+                                       "    <Name>Fixture%u</Name>\n"
+                                       "    <Directory>brisk-fixture-%u.directory</Directory>\n"
+                                       "    <Include>\n"
+                                       "      <Category>BriskFixture%u</Category>\n"
+                                       "    </Include>\n"
+                                       "  </Menu>\n",
+                                       i,
+                                       i,
+                                       i);
+        }
+        if (self->config.n_external > 0) {
+                autofree(gchar) *external_dir = g_build_filename(self->root, "external", NULL);
+
+                g_string_append_printf(apps,
+                                       "  <Menu>\n"
+                                       "    <Name>FixtureExternal</Name>\n"
+                                       "    <Directory>brisk-external.directory</Directory>\n"
+                                       "    <AppDir>%s</AppDir>\n"
+                                       "    <Include>\n"
+                                       "      <Category>BriskFixtureExternal</Category>\n"
+                                       "    </Include>\n"
+                                       "  </Menu>\n",
+                                       external_dir);
+        }
+        g_string_append(apps, "</Menu>\n");
+        brisk_fixture_write(dir, "mate-applications.menu", apps->str);
+        g_string_free(apps, TRUE);
+
+        /* Settings has a nested menu to exercise the non-root walk */
+        brisk_fixture_write(dir,
+                            "mate-settings.menu",
+                            FIXTURE_MENU_HEADER
+                            "<Menu>\n"
+                            "  <Name>Desktop</Name>\n"
+                            "  <DefaultAppDirs/>\n"
+                            "  <DefaultDirectoryDirs/>\n"
+                            "  <Menu>\n"
+                            "    <Name>FixtureSettings</Name>\n"
+                            "    <Directory>brisk-fixture-settings.directory</Directory>\n"
+                            "    <Menu>\n"
+                            "      <Name>FixtureNested</Name>\n"
+                            "      <Include><Category>BriskFixtureSettings</Category></Include>\n"
+                            "    </Menu>\n"
+                            "  </Menu>\n"
+                            "</Menu>\n");
+}
+
+void brisk_fixture_config_init(BriskFixtureConfig *config)
+{
+        *config = (BriskFixtureConfig){
+                .n_entries = 1000,
+                .n_sections = 12,
+                .skew = 0.0,
+                .n_keywords = 0,
+                .n_locales = 0,
+                .n_actions = 0,
+                .n_external = 0,
+                .unicode = FALSE,
+                .seed = 0,
+        };
+}
+
+BriskFixture *brisk_fixture_new(guint n_entries, guint n_sections)
+{
+        BriskFixtureConfig config = { 0 };
+
+        brisk_fixture_config_init(&config);
+        config.n_entries = n_entries;
+        config.n_sections = n_sections;
+
+        return brisk_fixture_new_full(&config, NULL);
+}
+
+BriskFixture *brisk_fixture_new_full(const BriskFixtureConfig *config, const gchar *root)
+{
+        BriskFixture *self = NULL;
+        GError *error = NULL;
+        autofree(gchar) *apps_dir = NULL;
+        autofree(gchar) *dirs_dir = NULL;
+        autofree(gchar) *menus_dir = NULL;
+        autofree(gchar) *external_dir = NULL;
+
+        self = g_new0(BriskFixture, 1);
+        self->config = *config;
+        self->config.n_sections = MAX(config->n_sections, 1);
+
+        if (root) {
+                self->root = g_strdup(root);
+        } else {
+                self->root = g_dir_make_tmp("brisk-fixture-XXXXXX", &error);
+                if (!self->root) {
+                        g_error("Failed to create fixture root: %s", error->message);
+                }
+                self->temporary = TRUE;
+        }
+
+        apps_dir = brisk_fixture_mkdir(self, "data/applications");
+        dirs_dir = brisk_fixture_mkdir(self, "data/desktop-directories");
+        menus_dir = brisk_fixture_mkdir(self, "config/menus");
+        g_free(brisk_fixture_mkdir(self, "data-home"));
+        g_free(brisk_fixture_mkdir(self, "config-home"));
+        external_dir = brisk_fixture_mkdir(self, "external");
+
+        brisk_fixture_write_entries(self, apps_dir);
+        brisk_fixture_write_external(self, external_dir);
+        brisk_fixture_write_directories(self, dirs_dir);
+        brisk_fixture_write_menus(self, menus_dir);
+
+        return self;
+}
+
+void brisk_fixture_export(BriskFixture *self)
+{
+        static const gchar *vars[][2] = {
+                { "XDG_DATA_DIRS", "data" },
+                { "XDG_DATA_HOME", "data-home" },
+                { "XDG_CONFIG_DIRS", "config" },
+                { "XDG_CONFIG_HOME", "config-home" },
+        };
+
+        for (guint i = 0; i < G_N_ELEMENTS(vars); i++) {
+                autofree(gchar) *path = g_build_filename(self->root, vars[i][1], NULL);
+                g_setenv(vars[i][0], path, TRUE);
+        }
+
+        /* Ensure we pick up mate-applications.menu, not a distro prefixed one */
+        g_unsetenv("XDG_MENU_PREFIX");
+}
+
+/**
+ * Recursively remove the given path
+ */
+static void brisk_fixture_remove(const gchar *path)
+{
+        GDir *dir = NULL;
+        const gchar *name = NULL;
+
+        dir = g_dir_open(path, 0, NULL);
+        if (!dir) {
+                g_unlink(path);
+                return;
+        }
+
+        while ((name = g_dir_read_name(dir)) != NULL) {
+                autofree(gchar) *child = g_build_filename(path, name, NULL);
+                brisk_fixture_remove(child);
+        }
+
+        g_dir_close(dir);
+        g_rmdir(path);
+}
+
+void brisk_fixture_free(BriskFixture *self)
+{
+        if (!self) {
+                return;
+        }
+        if (self->temporary) {
+                brisk_fixture_remove(self->root);
+        }
+        g_free(self->root);
+        g_free(self);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */
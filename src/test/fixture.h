@@ -0,0 +1,86 @@
+/*
+ * This file is part of brisk-menu.
+ *
+ * Copyright © 2017-2018 Brisk Menu Developers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * BriskFixtureConfig controls the shape of a generated tree. The same config
+ * always produces exactly the same tree.
+ */
+typedef struct BriskFixtureConfig {
+        guint n_entries;  /**<Number of .desktop files to write */
+        guint n_sections; /**<Number of root level menus */
+        gdouble skew;     /**<Zipf exponent for the category distribution, 0 is uniform */
+        guint n_keywords; /**<Extra keywords per entry */
+        guint n_locales;  /**<Number of translations per entry */
+        guint n_actions;  /**<Desktop actions per entry */
+        guint n_external; /**<Entries outside the XDG data dirs, so without a desktop ID */
+        gboolean unicode; /**<Use non-ASCII words in names and keywords */
+        guint32 seed;     /**<Random seed for skew, keywords and words */
+} BriskFixtureConfig;
+
+/**
+ * BriskFixture is a synthetic XDG tree of .desktop, .directory and .menu files
+ * used to load the backends hermetically.
+ */
+typedef struct BriskFixture {
+        gchar *root;               /**<Directory holding the tree */
+        gboolean temporary;        /**<Remove the tree when freed */
+        BriskFixtureConfig config; /**<How the tree was generated */
+} BriskFixture;
+
+/**
+ * Fill in the default configuration
+ */
+void brisk_fixture_config_init(BriskFixtureConfig *config);
+
+/**
+ * Construct a new fixture tree with the given number of entries distributed
+ * evenly across n_sections root level menus, in a temporary directory.
+ */
+BriskFixture *brisk_fixture_new(guint n_entries, guint n_sections);
+
+/**
+ * Construct a new fixture tree from the config. If root is NULL, a temporary
+ * directory is used and removed again when the fixture is freed.
+ */
+BriskFixture *brisk_fixture_new_full(const BriskFixtureConfig *config, const gchar *root);
+
+/**
+ * Point the XDG environment at the fixture. This must be called before
+ * anything has asked GLib for the system data or config directories, as they
+ * are cached on first use.
+ */
+void brisk_fixture_export(BriskFixture *fixture);
+
+/**
+ * Free the fixture, removing temporary trees from disk
+ */
+void brisk_fixture_free(BriskFixture *fixture);
+
+G_END_DECLS
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 expandtab:
+ * :indentSize=8:tabSize=8:noTabs=true:
+ */